@@ -0,0 +1,1100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_functions.h"
+#include "concurrent_map.h"
+#include "concurrent_search_server.h"
+#include "inverted_index.h"
+#include "log_duration.h"
+#include "process_queries.h"
+#include "ranking.h"
+#include "remove_duplicates.h"
+#include "search_server.h"
+#include "stop_words.h"
+#include "string_processing.h"
+#include "thread_pool.h"
+
+namespace {
+
+std::vector<Document> GenerateMatchedDocuments(std::mt19937& generator, int count) {
+    std::vector<Document> documents;
+    documents.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        documents.push_back({ i,
+            std::uniform_real_distribution<double>(0.0, 1.0)(generator),
+            std::uniform_int_distribution<int>(-10, 10)(generator) });
+    }
+    return documents;
+}
+
+std::string GenerateText(std::mt19937& generator, int word_count) {
+    using namespace std::literals;
+    std::string text;
+    for (int i = 0; i < word_count; ++i) {
+        if (!text.empty()) {
+            text.push_back(' ');
+        }
+        text += "w"s + std::to_string(std::uniform_int_distribution<int>(0, 5'000)(generator));
+    }
+    return text;
+}
+
+/*    : - w1 w2 w3  document_count    1,
+      generate_text */
+template <typename TextGenerator>
+SearchServer MakeSearchServer(int document_count, TextGenerator generate_text) {
+    using namespace std::literals;
+    SearchServer search_server("w1 w2 w3"s);
+    for (int i = 0; i < document_count; ++i) {
+        search_server.AddDocument(i, generate_text(), DocumentStatus::ACTUAL, { 1 });
+    }
+    return search_server;
+}
+
+SearchServer MakeSearchServer(std::mt19937& generator, int document_count) {
+    return MakeSearchServer(document_count, [&generator]() {
+        return GenerateText(generator, 70);
+    });
+}
+
+/*   word_count   ,  ,  - */
+std::vector<std::string> GenerateQueries(std::mt19937& generator, int query_count, int word_count,
+                                         bool has_minus_word = false)
+{
+    using namespace std::literals;
+    std::vector<std::string> queries;
+    queries.reserve(query_count);
+    for (int i = 0; i < query_count; ++i) {
+        queries.push_back(GenerateText(generator, word_count) +
+            (has_minus_word ? " -"s + GenerateText(generator, 1) : ""s));
+    }
+    return queries;
+}
+
+/*        ,   */
+std::vector<int> FindDuplicatesByWordSets(SearchServer& search_server) {
+    std::set<std::set<std::string>> documents;
+    std::vector<int> result;
+    for (const int document_id : search_server) {
+        std::set<std::string> words;
+        for (const auto& [word, frequency] : search_server.GetWordFrequencies(document_id)) {
+            words.emplace(word);
+        }
+        if (!documents.insert(std::move(words)).second) {
+            result.push_back(document_id);
+        }
+    }
+    return result;
+}
+
+/*   SplitIntoWords  find/find_first_not_of,   */
+std::vector<std::string_view> SplitIntoWordsByFind(std::string_view text) {
+    std::vector<std::string_view> result;
+    size_t pos = text.find_first_not_of(" ");
+    text.remove_prefix(std::min(text.size(), pos));
+    const size_t pos_end = text.npos;
+
+    while (!text.empty()) {
+        size_t space = text.find(' ');
+        result.push_back(space == pos_end ? text.substr(0, pos_end) : text.substr(0, space));
+        pos = text.find_first_not_of(" ", space);
+        text.remove_prefix(std::min(text.size(), pos));
+    }
+
+    return result;
+}
+
+template <typename Function>
+void RunInThreads(size_t thread_count, Function function) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back(function, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/*! \fn BenchmarkTopDocuments
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                      TopDocuments      \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkTopDocuments() {
+    using namespace std::literals;
+    static const int REPEAT_COUNT = 20;
+
+    std::mt19937 generator;
+    for (const int matched_count : {1'000, 10'000, 100'000, 1'000'000}) {
+        const auto matched_documents = GenerateMatchedDocuments(generator, matched_count);
+        const std::string mark = std::to_string(matched_count) + " matched"s;
+        double sort_relevance = 0;
+        double top_relevance = 0;
+        {
+            LOG_DURATION(mark + ", full sort"s);
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                auto documents = matched_documents;
+                std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+                documents.resize(std::min<size_t>(documents.size(), MAX_RESULT_DOCUMENT_COUNT));
+                sort_relevance += documents.back().relevance;
+            }
+        }
+        {
+            LOG_DURATION(mark + ", top-k"s);
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                TopDocuments top_documents(MAX_RESULT_DOCUMENT_COUNT);
+                for (const Document& document : matched_documents) {
+                    top_documents.Add(document);
+                }
+                top_relevance += top_documents.Extract().back().relevance;
+            }
+        }
+        std::cout << sort_relevance << " "s << top_relevance << std::endl;
+    }
+}
+
+/*! \fn BenchmarkTokenizer
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                       SplitIntoWords  WordTokenizer \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkTokenizer() {
+    using namespace std::literals;
+    static const int TEXT_COUNT = 10'000;
+    static const int REPEAT_COUNT = 20;
+
+    std::mt19937 generator;
+    std::vector<std::string> texts;
+    texts.reserve(TEXT_COUNT);
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        texts.push_back(GenerateText(generator, 70));
+    }
+
+    size_t find_word_count = 0;
+    {
+        LOG_DURATION("SplitIntoWords by find"s);
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            for (const std::string& text : texts) {
+                for (const std::string_view word : SplitIntoWordsByFind(text)) {
+                    find_word_count += std::none_of(word.begin(), word.end(), [](char c) {
+                        return c >= '\0' && c < ' ';
+                    });
+                }
+            }
+        }
+    }
+    size_t tokenizer_word_count = 0;
+    {
+        LOG_DURATION("WordTokenizer"s);
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            for (const std::string& text : texts) {
+                WordTokenizer tokenizer(text);
+                while (tokenizer.Next()) {
+                    tokenizer_word_count += tokenizer.IsValidWord();
+                }
+            }
+        }
+    }
+    std::cout << find_word_count << " "s << tokenizer_word_count << std::endl;
+}
+
+/*! \fn BenchmarkStopWords
+ *  \b   \b :   \n
+ *  \b   \b :   -   std::set   StopWordSet
+ *                          \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkStopWords() {
+    using namespace std::literals;
+    static const int TEXT_COUNT = 10'000;
+    static const int REPEAT_COUNT = 20;
+
+    std::mt19937 generator;
+    std::set<std::string, std::less<>> stop_words;
+    for (int i = 0; i < 100; ++i) {
+        stop_words.insert("w"s + std::to_string(std::uniform_int_distribution<int>(0, 5'000)(generator)));
+    }
+    const StopWordSet stop_word_set(stop_words);
+
+    std::vector<std::string> texts;
+    std::vector<std::string_view> words;
+    texts.reserve(TEXT_COUNT);
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        texts.push_back(GenerateText(generator, 70));
+        const auto text_words = SplitIntoWords(texts.back());
+        words.insert(words.end(), text_words.begin(), text_words.end());
+    }
+
+    size_t set_count = 0;
+    {
+        LOG_DURATION("std::set"s);
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            for (const std::string_view word : words) {
+                set_count += stop_words.count(word);
+            }
+        }
+    }
+    size_t perfect_hash_count = 0;
+    {
+        LOG_DURATION("StopWordSet"s);
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            for (const std::string_view word : words) {
+                perfect_hash_count += stop_word_set.Contains(word);
+            }
+        }
+    }
+    std::cout << set_count << " "s << perfect_hash_count << std::endl;
+}
+
+/*! \fn BenchmarkConcurrentMap
+ *  \b   \b :   \n
+ *  \b   \b :       std::map  
+ *                         ConcurrentMap    ,  
+ *                      ( )    .  
+ *                          \n
+ *  \b  \b :         \n
+ *  \return  \n
+ */
+void BenchmarkConcurrentMap() {
+    using namespace std::literals;
+    static const int OPERATION_COUNT = 200'000;
+
+    const size_t thread_count = std::max(4u, std::thread::hardware_concurrency());
+    const double expected_sum = static_cast<double>(thread_count) * OPERATION_COUNT;
+    auto sum_values = [](const std::map<int, double>& values) {
+        double sum = 0.0;
+        for (const auto& [key, value] : values) {
+            sum += value;
+        }
+        return sum;
+    };
+    for (const int key_count : {16, 100'000}) {
+        const std::string mark = std::to_string(thread_count) + " threads, "s +
+            std::to_string(key_count) + " keys"s;
+        std::map<int, double> values;
+        {
+            std::mutex values_mutex;
+            LOG_DURATION(mark + ", std::map + mutex"s);
+            RunInThreads(thread_count, [&](size_t thread) {
+                for (int i = 0; i < OPERATION_COUNT; ++i) {
+                    std::lock_guard guard(values_mutex);
+                    values[static_cast<int>((i * 7919 + thread) % key_count)] += 1.0;
+                }
+            });
+        }
+        bool is_sum_correct = sum_values(values) == expected_sum;
+        for (const size_t stripe_count : {1, 64}) {
+            ConcurrentMap<int, double> concurrent_values(stripe_count);
+            {
+                LOG_DURATION(mark + ", ConcurrentMap "s + std::to_string(stripe_count) + " stripes"s);
+                RunInThreads(thread_count, [&](size_t thread) {
+                    for (int i = 0; i < OPERATION_COUNT; ++i) {
+                        concurrent_values.Add(static_cast<int>((i * 7919 + thread) % key_count), 1.0);
+                    }
+                });
+            }
+            is_sum_correct = is_sum_correct && sum_values(concurrent_values.BuildOrdinaryMap()) == expected_sum;
+        }
+        std::cout << (is_sum_correct ? "sums match"s : "sums differ"s) << std::endl;
+    }
+}
+
+/*! \fn BenchmarkAddDocuments
+ *  \b   \b :   \n
+ *  \b   \b :       AddDocument
+ *                         AddDocuments \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkAddDocuments() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int WORD_COUNT = 70;
+
+    std::mt19937 generator;
+    std::vector<std::string> texts;
+    texts.reserve(DOCUMENT_COUNT);
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        texts.push_back(GenerateText(generator, WORD_COUNT));
+    }
+    std::vector<RawDocument> documents;
+    documents.reserve(DOCUMENT_COUNT);
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        documents.push_back({ i, texts[i], DocumentStatus::ACTUAL, { 1, 2, 3 } });
+    }
+
+    const std::string mark = std::to_string(DOCUMENT_COUNT) + " documents"s;
+    {
+        LOG_DURATION(mark + ", AddDocument"s);
+        SearchServer search_server("w0"s);
+        for (const auto& document : documents) {
+            search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+    }
+    {
+        LOG_DURATION(mark + ", AddDocuments seq"s);
+        SearchServer search_server("w0"s);
+        search_server.AddDocuments(std::execution::seq, documents);
+    }
+    {
+        LOG_DURATION(mark + ", AddDocuments par"s);
+        SearchServer search_server("w0"s);
+        search_server.AddDocuments(std::execution::par, documents);
+    }
+}
+
+/*! \fn BenchmarkPreparedQueries
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                       ,       ,
+ *                                 \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkPreparedQueries() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 100;
+    static const int REPEAT_COUNT = 200;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 3, true);
+    std::vector<PreparedQuery> prepared_queries;
+    for (const std::string& query : queries) {
+        prepared_queries.push_back(search_server.PrepareQuery(query));
+    }
+    SearchOptions options;
+    options.scoring_mode = ScoringMode::WAND;
+
+    for (const size_t capacity : {size_t(0), QUERY_CACHE_CAPACITY}) {
+        search_server.SetQueryCacheCapacity(capacity);
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION("query cache capacity "s + std::to_string(capacity));
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                for (const std::string& query : queries) {
+                    for (const Document& document : search_server.FindTopDocuments(
+                        std::execution::seq, query, DocumentStatus::ACTUAL, options)) {
+                        total_relevance += document.relevance;
+                    }
+                }
+            }
+        }
+        std::cout << total_relevance << std::endl;
+
+        size_t text_size = 0;
+        {
+            LOG_DURATION("preparation only, query cache capacity "s + std::to_string(capacity));
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                for (const std::string& query : queries) {
+                    text_size += search_server.PrepareQuery(query).GetText().size();
+                }
+            }
+        }
+        std::cout << text_size << std::endl;
+    }
+    double total_relevance = 0.0;
+    {
+        LOG_DURATION("prepared queries"s);
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            for (const PreparedQuery& query : prepared_queries) {
+                for (const Document& document : search_server.FindTopDocuments(
+                    std::execution::seq, query, DocumentStatus::ACTUAL, options)) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+    }
+    std::cout << total_relevance << std::endl;
+}
+
+/*! \fn BenchmarkPostingLists
+ *  \b   \b :   \n
+ *  \b   \b :          \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkPostingLists() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 50'000;
+    static const int WORD_COUNT = 70;
+    static const int TERM_COUNT = 5'000;
+    static const int PASS_COUNT = 10;
+
+    std::mt19937 generator;
+    /*     ,      */
+    std::vector<std::string> words;
+    for (int term_id = 0; term_id < TERM_COUNT; ++term_id) {
+        words.push_back("w"s + std::to_string(term_id));
+    }
+    InvertedIndex index;
+    for (const std::string& word : words) {
+        index.AddTerm(word);
+    }
+    /*       ,    */
+    std::vector<double> weights(TERM_COUNT);
+    for (int term_id = 0; term_id < TERM_COUNT; ++term_id) {
+        weights[term_id] = 1.0 / (term_id + 1);
+    }
+    std::discrete_distribution<int> term_distribution(weights.begin(), weights.end());
+    std::vector<int> term_ids(WORD_COUNT);
+    for (int document_id = 0; document_id < DOCUMENT_COUNT; ++document_id) {
+        for (int& term_id : term_ids) {
+            term_id = term_distribution(generator);
+        }
+        index.AddDocument(document_id, term_ids);
+    }
+    index.Flush();
+    index.WaitForMerges();
+
+    const auto stats = index.GetMemoryStats();
+    std::cout << "postings: "s << stats.posting_count << " in "s << stats.segment_count << " segments, "s
+              << stats.GetBytesPerPosting() << " bytes/posting (uncompressed: "s
+              << sizeof(int) + sizeof(double) << " bytes/posting)"s << std::endl;
+
+    size_t decoded_count = 0;
+    double term_freq_sum = 0.0;
+    const auto start_time = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASS_COUNT; ++pass) {
+        for (size_t segment = 0; segment < index.GetSegmentCount(); ++segment) {
+            for (int term_id = 0; term_id < TERM_COUNT; ++term_id) {
+                InvertedIndex::PostingIterator iterator(index.GetPostings(segment, term_id), 0, DOCUMENT_COUNT);
+                for (; !iterator.IsEnd(); iterator.Next()) {
+                    term_freq_sum += iterator.GetTermFreq();
+                    ++decoded_count;
+                }
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "decode: "s << decoded_count / seconds / 1e6 << " M postings/s ("s
+              << term_freq_sum << ")"s << std::endl;
+}
+
+/*! \fn BenchmarkLoadIndex
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                             \n
+ *  \b  \b :         \n
+ *  \return  \n
+ */
+void BenchmarkLoadIndex() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int WORD_COUNT = 70;
+    static const int QUERY_COUNT = 100;
+    static const char* INDEX_PATH = "search_index.bin";
+
+    std::mt19937 generator;
+    std::vector<std::string> texts;
+    std::vector<RawDocument> documents;
+    texts.reserve(DOCUMENT_COUNT);
+    documents.reserve(DOCUMENT_COUNT);
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        texts.push_back(GenerateText(generator, WORD_COUNT));
+    }
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        documents.push_back({ i, texts[i], DocumentStatus::ACTUAL, { i % 10 } });
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        queries.push_back(GenerateText(generator, 5));
+    }
+
+    const std::string mark = std::to_string(DOCUMENT_COUNT) + " documents"s;
+    SearchServer search_server("w0"s);
+    {
+        LOG_DURATION(mark + ", build from texts"s);
+        search_server.AddDocuments(std::execution::par, documents);
+    }
+    {
+        LOG_DURATION(mark + ", save"s);
+        search_server.Save(INDEX_PATH);
+    }
+    std::shared_ptr<const MappedFile> index_file;
+    {
+        LOG_DURATION(mark + ", map"s);
+        index_file = MappedFile::Open(INDEX_PATH);
+    }
+    std::optional<SearchServer> loaded_server;
+    {
+        LOG_DURATION(mark + ", load"s);
+        loaded_server.emplace(index_file);
+    }
+    {
+        LOG_DURATION(mark + ", load with checksums"s);
+        SearchServer verified_server(index_file, true);
+    }
+
+    int mismatch_count = 0;
+    {
+        LOG_DURATION(std::to_string(QUERY_COUNT) + " queries on loaded index"s);
+        for (const std::string& query : queries) {
+            const auto expected = search_server.FindTopDocuments(query);
+            const auto actual = loaded_server->FindTopDocuments(query);
+            mismatch_count += !std::equal(expected.begin(), expected.end(), actual.begin(), actual.end(),
+                [](const Document& lhs, const Document& rhs) {
+                    return lhs.id == rhs.id && lhs.relevance == rhs.relevance && lhs.rating == rhs.rating;
+                });
+        }
+    }
+    std::cout << "index file: "s << index_file->GetSize() << " bytes, "s
+              << mismatch_count << " mismatched queries"s << std::endl;
+
+    loaded_server.reset();
+    index_file.reset();
+    std::remove(INDEX_PATH);
+}
+
+/*! \fn BenchmarkResultCache
+ *  \b   \b :   \n
+ *  \b   \b :      
+ *                           ,    \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkResultCache() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int POPULAR_QUERY_COUNT = 50;
+    static const int QUERY_COUNT = 20'000;
+    static const size_t RESULT_CACHE_CAPACITY = 256;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> popular_queries = GenerateQueries(generator, POPULAR_QUERY_COUNT, 3);
+    std::vector<std::string> queries;
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        queries.push_back(popular_queries[std::uniform_int_distribution<int>(0, POPULAR_QUERY_COUNT - 1)(generator)]);
+    }
+
+    for (const size_t capacity : {size_t(0), RESULT_CACHE_CAPACITY}) {
+        search_server.SetResultCacheCapacity(capacity);
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION("result cache capacity "s + std::to_string(capacity));
+            for (const auto& documents : ProcessQueries(search_server, queries)) {
+                for (const Document& document : documents) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+        const ResultCache::Stats stats = search_server.GetResultCacheStats();
+        std::cout << total_relevance << ", hits "s << stats.hits << ", misses "s << stats.misses
+                  << ", evictions "s << stats.evictions << std::endl;
+    }
+}
+
+/*! \fn BenchmarkBatchQueries
+ *  \b   \b :   \n
+ *  \b   \b :  ProcessQueries       
+ *                               \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkBatchQueries() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 5'000;
+    static const int POPULAR_WORD_COUNT = 20;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(DOCUMENT_COUNT, [&generator]() {
+        return GenerateText(generator, 70) + " p"s +
+            std::to_string(std::uniform_int_distribution<int>(0, POPULAR_WORD_COUNT - 1)(generator));
+    });
+    std::vector<std::string> queries;
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        queries.push_back("p"s + std::to_string(std::uniform_int_distribution<int>(0, POPULAR_WORD_COUNT - 1)(generator)) +
+            " "s + GenerateText(generator, 3));
+    }
+
+    std::vector<std::vector<std::vector<Document>>> results;
+    for (const auto& [name, strategy] : {std::pair("per query"s, QueryBatchStrategy::PER_QUERY),
+                                         std::pair("shared postings"s, QueryBatchStrategy::SHARED_POSTINGS)}) {
+        LOG_DURATION(name);
+        results.push_back(ProcessQueries(search_server, queries, strategy));
+    }
+    double total_relevance = 0.0;
+    bool is_same = true;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        is_same = is_same && results[0][i].size() == results[1][i].size();
+        for (size_t j = 0; is_same && j < results[0][i].size(); ++j) {
+            is_same = results[0][i][j].id == results[1][i][j].id &&
+                results[0][i][j].relevance == results[1][i][j].relevance;
+            total_relevance += results[0][i][j].relevance;
+        }
+    }
+    std::cout << total_relevance << (is_same ? ", results match"s : ", results differ"s) << std::endl;
+}
+
+/*! \fn BenchmarkThreadPool
+ *  \b   \b :   \n
+ *  \b   \b :  ProcessQueries     
+ *                       std::execution::par    ,    \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkThreadPool() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 2'000;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 5);
+
+    auto thread_pool = std::make_shared<ThreadPool>();
+    for (const auto& [name, pool] : {std::pair("execution::par"s, std::shared_ptr<ThreadPool>()),
+                                     std::pair("thread pool"s, thread_pool)}) {
+        search_server.SetThreadPool(pool);
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION("ProcessQueries on "s + name);
+            for (const auto& documents : ProcessQueries(search_server, queries)) {
+                for (const Document& document : documents) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+        {
+            LOG_DURATION("FindTopDocuments(par) on "s + name);
+            for (const std::string& query : queries) {
+                for (const Document& document : search_server.FindTopDocuments(std::execution::par, query)) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+        std::cout << total_relevance << std::endl;
+    }
+    const auto stats = thread_pool->GetWorkerStats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        std::cout << "worker "s << i << ": "s << stats[i].executed_tasks << " tasks, "s
+                  << stats[i].stolen_tasks << " stolen"s << std::endl;
+    }
+}
+
+/*! \fn BenchmarkJoinedStream
+ *  \b   \b :   \n
+ *  \b   \b :  ProcessQueriesJoined     
+ *                      ProcessQueriesJoinedStream:        \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkJoinedStream() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 20'000;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 3);
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        double total_relevance = 0.0;
+        std::optional<std::chrono::steady_clock::duration> first_document_time;
+        for (const Document& document : ProcessQueriesJoined(search_server, queries)) {
+            if (!first_document_time) {
+                first_document_time = std::chrono::steady_clock::now() - start;
+            }
+            total_relevance += document.relevance;
+        }
+        const auto total_time = std::chrono::steady_clock::now() - start;
+        std::cout << "ProcessQueriesJoined: "s << total_relevance << ", first document after "s
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(*first_document_time).count() << " ms, total "s
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count() << " ms"s << std::endl;
+    }
+    {
+        const auto start = std::chrono::steady_clock::now();
+        double total_relevance = 0.0;
+        std::optional<std::chrono::steady_clock::duration> first_document_time;
+        for (const Document& document : ProcessQueriesJoinedStream(search_server, queries)) {
+            if (!first_document_time) {
+                first_document_time = std::chrono::steady_clock::now() - start;
+            }
+            total_relevance += document.relevance;
+        }
+        const auto total_time = std::chrono::steady_clock::now() - start;
+        std::cout << "ProcessQueriesJoinedStream: "s << total_relevance << ", first document after "s
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(*first_document_time).count() << " ms, total "s
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count() << " ms"s << std::endl;
+    }
+}
+
+/*! \fn BenchmarkAsyncDeadline
+ *  \b   \b :   \n
+ *  \b   \b :         ,
+ *                       ,    \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkAsyncDeadline() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 200;
+    static const auto QUERY_TIMEOUT = 20ms;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 70);
+    const ConcurrentSearchServer concurrent_search_server(std::move(search_server));
+
+    for (const bool has_deadline : {false, true}) {
+        size_t cancelled_count = 0;
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION(has_deadline ? "async with deadline"s : "async without deadline"s);
+            std::vector<std::future<std::vector<Document>>> results;
+            std::vector<SearchOptions> options(queries.size());
+            for (size_t i = 0; i < queries.size(); ++i) {
+                if (has_deadline) {
+                    options[i].cancellation = CancellationToken::Create(
+                        CancellationToken::Clock::now() + QUERY_TIMEOUT);
+                }
+                results.push_back(concurrent_search_server.FindTopDocumentsAsync(queries[i], DocumentStatus::ACTUAL, options[i]));
+            }
+            for (size_t i = 0; i < results.size(); ++i) {
+                for (const Document& document : results[i].get()) {
+                    total_relevance += document.relevance;
+                }
+                cancelled_count += options[i].cancellation.IsCancelled() ? 1 : 0;
+            }
+        }
+        std::cout << total_relevance << ", cancelled "s << cancelled_count << " of "s << queries.size() << std::endl;
+    }
+}
+
+/*! \fn BenchmarkPublishUpdates
+ *  \b   \b :   \n
+ *  \b   \b :          
+ *                       ,      \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkPublishUpdates() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int UPDATE_COUNT = 1'000;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    {
+        LOG_DURATION("copy of server x"s + std::to_string(UPDATE_COUNT));
+        for (int i = 0; i < UPDATE_COUNT; ++i) {
+            const SearchServer copy = search_server;
+        }
+    }
+
+    const std::vector<std::string> queries = GenerateQueries(generator, UPDATE_COUNT, 10);
+    ConcurrentSearchServer concurrent_search_server(std::move(search_server));
+    size_t found_count = 0;
+    {
+        LOG_DURATION("add and search x"s + std::to_string(UPDATE_COUNT));
+        for (int i = 0; i < UPDATE_COUNT; ++i) {
+            concurrent_search_server.AddDocument(DOCUMENT_COUNT + i, GenerateText(generator, 70), DocumentStatus::ACTUAL, { 1 });
+            found_count += concurrent_search_server.FindTopDocuments(queries[i]).size();
+        }
+    }
+    std::cout << found_count << " found"s << std::endl;
+}
+
+/*! \fn BenchmarkTextArena
+ *  \b   \b :   \n
+ *  \b   \b :          
+ *                              ,
+ *                           \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void BenchmarkTextArena() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int CHURN_ROUND_COUNT = 5;
+    static const int CHURN_DOCUMENT_COUNT = DOCUMENT_COUNT / 2;
+
+    std::mt19937 generator;
+    SearchServer search_server("w1 w2 w3"s);
+    size_t added_count = 0;
+    size_t added_bytes = 0;
+    const auto print_stats = [&search_server, &added_count, &added_bytes](std::string_view stage) {
+        const auto stats = search_server.GetTextMemoryStats();
+        /*           */
+        const auto string_stats = TextArena::EstimateStringMemoryStats(added_count, added_bytes);
+        std::cout << stage << ": "s << stats.text_count << " texts, "s << stats.live_bytes << " bytes in "s
+                  << stats.chunk_count << " chunks, "s << stats.reserved_bytes << " bytes reserved (std::string per document: "s
+                  << string_stats.reserved_bytes << " bytes)"s << std::endl;
+    };
+
+    int next_document_id = 0;
+    const auto add_document = [&](std::mt19937& generator) {
+        const std::string text = GenerateText(generator, 70);
+        search_server.AddDocument(next_document_id++, text, DocumentStatus::ACTUAL, { 1 });
+        ++added_count;
+        added_bytes += text.size();
+    };
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        add_document(generator);
+    }
+    print_stats("texts before churn"s);
+    {
+        LOG_DURATION("text churn"s);
+        for (int round = 0; round < CHURN_ROUND_COUNT; ++round) {
+            const int first_document_id = next_document_id - DOCUMENT_COUNT;
+            for (int i = 0; i < CHURN_DOCUMENT_COUNT; ++i) {
+                search_server.RemoveDocument(first_document_id + i);
+            }
+            for (int i = 0; i < CHURN_DOCUMENT_COUNT; ++i) {
+                add_document(generator);
+            }
+        }
+    }
+    print_stats("texts after churn"s);
+}
+
+void BenchmarkRemoveDuplicates() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 50'000;
+    static const int WORD_COUNT = 70;
+
+    std::mt19937 generator;
+    SearchServer search_server("w1 w2 w3"s);
+    std::vector<std::string> texts;
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        const int kind = std::uniform_int_distribution<int>(0, 9)(generator);
+        if (texts.empty() || kind >= 4) {
+            texts.push_back(GenerateText(generator, WORD_COUNT));
+        }
+        else {
+            /*      ,       */
+            std::vector<std::string_view> words = SplitIntoWords(
+                texts[std::uniform_int_distribution<size_t>(0, texts.size() - 1)(generator)]);
+            std::shuffle(words.begin(), words.end(), generator);
+            std::string text = kind < 3 ? ""s : GenerateText(generator, 1);
+            for (size_t j = kind < 3 ? 0 : 1; j < words.size(); ++j) {
+                text += (text.empty() ? ""s : " "s) + std::string(words[j]);
+            }
+            texts.push_back(std::move(text));
+        }
+        search_server.AddDocument(i, texts.back(), DocumentStatus::ACTUAL, { 1 });
+    }
+
+    {
+        LOG_DURATION("duplicates by word sets"s);
+        std::cout << FindDuplicatesByWordSets(search_server).size() << " exact duplicates"s << std::endl;
+    }
+    {
+        LOG_DURATION("duplicates by fingerprints"s);
+        std::cout << FindDuplicates(search_server, { 1.0, nullptr }).size() << " exact duplicates"s << std::endl;
+    }
+    {
+        LOG_DURATION("near duplicates by MinHash"s);
+        std::cout << FindDuplicates(search_server, { 0.9, nullptr }).size() << " near duplicates"s << std::endl;
+    }
+    {
+        LOG_DURATION("remove duplicates"s);
+        RemoveDuplicates(search_server, { 0.9, nullptr });
+    }
+    std::cout << search_server.GetDocumentCount() << " documents left"s << std::endl;
+}
+
+void BenchmarkRemoveDocuments() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+
+    std::mt19937 generator;
+    std::vector<std::string> texts;
+    for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+        texts.push_back(GenerateText(generator, 70) + " u"s + std::to_string(i));
+    }
+    std::vector<int> removed_ids;
+    for (int i = 0; i < DOCUMENT_COUNT; i += 2) {
+        removed_ids.push_back(i);
+    }
+
+    for (const bool is_batch : {false, true}) {
+        SearchServer search_server("w1 w2 w3"s);
+        for (int i = 0; i < DOCUMENT_COUNT; ++i) {
+            search_server.AddDocument(i, texts[i], DocumentStatus::ACTUAL, { 1 });
+        }
+        {
+            LOG_DURATION(is_batch ? "RemoveDocuments"s : "RemoveDocument"s);
+            if (is_batch) {
+                search_server.RemoveDocuments(removed_ids);
+            }
+            else {
+                for (const int document_id : removed_ids) {
+                    search_server.RemoveDocument(document_id);
+                }
+            }
+        }
+        const auto stats = search_server.GetIndexMemoryStats();
+        std::cout << stats.term_count << " terms, "s << stats.posting_count << " postings"s << std::endl;
+    }
+}
+
+void BenchmarkMatchDocuments() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 2'000;
+    static const size_t PAGE_SIZE = 20;
+
+    std::mt19937 generator;
+    const SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 10, true);
+    std::vector<std::vector<int>> pages;
+    for (const std::string& query : queries) {
+        pages.emplace_back();
+        for (const Document& document : search_server.FindTopDocuments(query)) {
+            pages.back().push_back(document.id);
+        }
+        while (pages.back().size() < PAGE_SIZE) {
+            pages.back().push_back(std::uniform_int_distribution<int>(0, DOCUMENT_COUNT - 1)(generator));
+        }
+    }
+
+    size_t matched_count = 0;
+    {
+        LOG_DURATION("MatchDocument per result"s);
+        for (int i = 0; i < QUERY_COUNT; ++i) {
+            for (const int document_id : pages[i]) {
+                matched_count += std::get<0>(search_server.MatchDocument(queries[i], document_id)).size();
+            }
+        }
+    }
+    std::cout << matched_count << " matched words"s << std::endl;
+    matched_count = 0;
+    {
+        LOG_DURATION("MatchDocuments per page"s);
+        for (int i = 0; i < QUERY_COUNT; ++i) {
+            for (const auto& [words, status] : search_server.MatchDocuments(queries[i], pages[i])) {
+                matched_count += words.size();
+            }
+        }
+    }
+    std::cout << matched_count << " matched words"s << std::endl;
+}
+
+void BenchmarkTermWeights() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 5'000;
+    static const int REPEAT_COUNT = 20;
+
+    std::mt19937 generator;
+    SearchServer search_server = MakeSearchServer(generator, DOCUMENT_COUNT);
+    const std::vector<std::string> queries = GenerateQueries(generator, QUERY_COUNT, 10, true);
+    /*   ,        */
+    search_server.SetQueryCacheCapacity(0);
+    SearchOptions options;
+    options.scoring_mode = ScoringMode::WAND;
+
+    for (const bool is_enabled : {false, true}) {
+        search_server.SetTermWeightTableEnabled(is_enabled);
+        const std::string name = is_enabled ? "term weight table"s : "term weights per query"s;
+        size_t query_bytes = 0;
+        {
+            LOG_DURATION(name + ", PrepareQuery"s);
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                for (const std::string& query : queries) {
+                    query_bytes += search_server.PrepareQuery(query).GetText().size();
+                }
+            }
+        }
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION(name + ", WAND"s);
+            for (const std::string& query : queries) {
+                for (const Document& document : search_server.FindTopDocuments(
+                    std::execution::seq, query, DocumentStatus::ACTUAL, options)) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+        std::cout << query_bytes << " query bytes, "s << total_relevance << std::endl;
+    }
+}
+
+void BenchmarkRanking() {
+    using namespace std::literals;
+    static const int DOCUMENT_COUNT = 20'000;
+    static const int QUERY_COUNT = 2'000;
+
+    std::mt19937 generator;
+    const SearchServer search_server = MakeSearchServer(DOCUMENT_COUNT, [&generator]() {
+        return GenerateText(generator, std::uniform_int_distribution<int>(10, 130)(generator));
+    });
+    std::vector<PreparedQuery> queries;
+    for (const std::string& query : GenerateQueries(generator, QUERY_COUNT, 5, true)) {
+        queries.push_back(search_server.PrepareQuery(query));
+    }
+
+    const auto run = [&search_server, &queries](const std::string& name, ScoringMode scoring_mode, const auto& ranking) {
+        SearchOptions options;
+        options.scoring_mode = scoring_mode;
+        double total_relevance = 0.0;
+        {
+            LOG_DURATION(name);
+            for (const PreparedQuery& query : queries) {
+                for (const Document& document : search_server.FindTopDocuments(
+                    std::execution::seq, query, DocumentStatus::ACTUAL, options, ranking)) {
+                    total_relevance += document.relevance;
+                }
+            }
+        }
+        std::cout << total_relevance << std::endl;
+    };
+    run("TF-IDF, exhaustive"s, ScoringMode::EXHAUSTIVE, TfIdfRanking{});
+    run("BM25, exhaustive"s, ScoringMode::EXHAUSTIVE, Bm25Ranking{});
+    run("TF-IDF, WAND"s, ScoringMode::WAND, TfIdfRanking{});
+    run("BM25, WAND"s, ScoringMode::WAND, Bm25Ranking{});
+}
+
+} // namespace
+
+/*! \fn RunBenchmarks
+ *  \b   \b :   \n
+ *  \b   \b :           \n
+ *  \b  \b :        : 
+ *                       TestSearchServer \n
+ *  \return  \n
+ */
+void RunBenchmarks() {
+    BenchmarkTopDocuments();
+    BenchmarkTokenizer();
+    BenchmarkStopWords();
+    BenchmarkConcurrentMap();
+    BenchmarkAddDocuments();
+    BenchmarkPreparedQueries();
+    BenchmarkPostingLists();
+    BenchmarkLoadIndex();
+    BenchmarkResultCache();
+    BenchmarkBatchQueries();
+    BenchmarkThreadPool();
+    BenchmarkJoinedStream();
+    BenchmarkAsyncDeadline();
+    BenchmarkPublishUpdates();
+    BenchmarkTextArena();
+    BenchmarkRemoveDuplicates();
+    BenchmarkRemoveDocuments();
+    BenchmarkMatchDocuments();
+    BenchmarkTermWeights();
+    BenchmarkRanking();
+}
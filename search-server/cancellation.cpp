@@ -0,0 +1,23 @@
+#include "cancellation.h"
+
+/*! \fn CancellationToken::Create
+ *  \b   \b :   \n
+ *  \b   \b :  ,     Cancel
+ *                             \n
+ *  \b  \b :  \n
+ *  \param[in] deadline    \n
+ *  \return  \n
+ */
+CancellationToken CancellationToken::Create(Clock::time_point deadline) {
+    CancellationToken token;
+    token.is_cancelled_ = std::make_shared<std::atomic<bool>>(false);
+    token.deadline_ = deadline;
+    return token;
+}
+
+/*         :       */
+void CancellationToken::Cancel() const {
+    if (is_cancelled_) {
+        is_cancelled_->store(true, std::memory_order_relaxed);
+    }
+}
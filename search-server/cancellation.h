@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/*   :     .    ,
+         .       */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+    static CancellationToken Create(Clock::time_point deadline = Clock::time_point::max());
+
+    void Cancel() const;
+    bool IsCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> is_cancelled_;
+    Clock::time_point deadline_ = Clock::time_point::max();
+};
+
+/*! \fn CancellationToken::IsCancelled
+ *  \b   \b :   \n
+ *  \b   \b :  .      , 
+ *                               \n
+ *  \b  \b :  \n
+ *  \return true,       \n
+ */
+inline bool CancellationToken::IsCancelled() const {
+    if (!is_cancelled_) {
+        return false;
+    }
+    if (is_cancelled_->load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_;
+}
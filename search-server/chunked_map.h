@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chunked_vector.h"
+
+/*     ,      ,
+     ChunkedVector:         ,
+       .        ,
+     .    ,     */
+template <typename Key, typename Value>
+class ChunkedMap {
+public:
+    static constexpr size_t MAX_CHUNK_SIZE = 512;
+    static constexpr size_t MIN_CHUNK_SIZE = MAX_CHUNK_SIZE / 4;
+
+    using Entry = std::pair<Key, Value>;
+
+    /*         */
+    template <bool IS_KEY_ITERATOR>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::conditional_t<IS_KEY_ITERATOR, Key, Entry>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        BasicIterator() = default;
+
+        reference operator*() const {
+            const Entry& entry = (*map_->chunks_[chunk_])[position_];
+            if constexpr (IS_KEY_ITERATOR) {
+                return entry.first;
+            }
+            else {
+                return entry;
+            }
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        BasicIterator& operator++() {
+            if (++position_ == map_->chunks_[chunk_]->size()) {
+                ++chunk_;
+                position_ = 0;
+            }
+            return *this;
+        }
+
+        BasicIterator operator++(int) {
+            BasicIterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const BasicIterator& other) const {
+            return chunk_ == other.chunk_ && position_ == other.position_;
+        }
+
+        bool operator!=(const BasicIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkedMap;
+
+        BasicIterator(const ChunkedMap* map, size_t chunk, size_t position)
+            : map_(map)
+            , chunk_(chunk)
+            , position_(position)
+        {
+        }
+
+        const ChunkedMap* map_ = nullptr;
+        size_t chunk_ = 0;
+        size_t position_ = 0;
+    };
+
+    using Iterator = BasicIterator<false>;
+    using KeyIterator = BasicIterator<true>;
+
+    ChunkedMap() = default;
+    explicit ChunkedMap(const std::vector<Entry>& sorted_entries);
+
+    size_t size() const;
+    bool empty() const;
+    const Value* Find(const Key& key) const;
+    bool Insert(const Key& key, Value value);
+    bool Erase(const Key& key);
+    Iterator begin() const;
+    Iterator end() const;
+    KeyIterator BeginKeys() const;
+    KeyIterator EndKeys() const;
+    size_t GetMemoryBytes() const;
+
+private:
+    using Chunk = std::vector<Entry>;
+
+    std::vector<std::shared_ptr<Chunk>> chunks_;
+    std::vector<Key> first_keys_; /*!<          */
+    size_t size_ = 0;
+
+    size_t FindChunk(const Key& key) const;
+    void MergeChunk(size_t chunk);
+};
+
+/*! \fn ChunkedMap::ChunkedMap
+ *  \b   \b :   \n
+ *  \b   \b :    ,   . 
+ *                       ,       \n
+ *  \b  \b :      \n
+ *  \param[in] sorted_entries  \n
+ */
+template <typename Key, typename Value>
+ChunkedMap<Key, Value>::ChunkedMap(const std::vector<Entry>& sorted_entries)
+    : size_(sorted_entries.size())
+{
+    for (size_t first = 0; first < sorted_entries.size(); first += MAX_CHUNK_SIZE / 2) {
+        const size_t last = std::min(sorted_entries.size(), first + MAX_CHUNK_SIZE / 2);
+        chunks_.push_back(std::make_shared<Chunk>(sorted_entries.begin() + first, sorted_entries.begin() + last));
+        first_keys_.push_back(sorted_entries[first].first);
+    }
+}
+
+template <typename Key, typename Value>
+size_t ChunkedMap<Key, Value>::size() const {
+    return size_;
+}
+
+template <typename Key, typename Value>
+bool ChunkedMap<Key, Value>::empty() const {
+    return size_ == 0;
+}
+
+/*! \fn ChunkedMap::Find
+ *  \b   \b :   \n
+ *  \b   \b :     \n
+ *  \b  \b :       \n
+ *  \param[in] key  \n
+ *  \return     nullptr,    \n
+ */
+template <typename Key, typename Value>
+const Value* ChunkedMap<Key, Value>::Find(const Key& key) const {
+    if (chunks_.empty()) {
+        return nullptr;
+    }
+    const Chunk& chunk = *chunks_[FindChunk(key)];
+    const auto iterator = std::lower_bound(chunk.begin(), chunk.end(), key,
+        [](const Entry& entry, const Key& value) {return entry.first < value;});
+    return iterator != chunk.end() && iterator->first == key ? &iterator->second : nullptr;
+}
+
+/*! \fn ChunkedMap::Insert
+ *  \b   \b :   \n
+ *  \b   \b :  . ,    , ,
+ *                          \n
+ *  \b  \b :     \n
+ *  \param[in] key  \n
+ *  \param[in] value  \n
+ *  \return true,    \n
+ */
+template <typename Key, typename Value>
+bool ChunkedMap<Key, Value>::Insert(const Key& key, Value value) {
+    if (chunks_.empty()) {
+        chunks_.push_back(std::make_shared<Chunk>(1, Entry(key, std::move(value))));
+        first_keys_.push_back(key);
+        ++size_;
+        return true;
+    }
+
+    const size_t index = FindChunk(key);
+    const Chunk& shared_chunk = *chunks_[index];
+    const auto position = std::lower_bound(shared_chunk.begin(), shared_chunk.end(), key,
+        [](const Entry& entry, const Key& value) {return entry.first < value;}) - shared_chunk.begin();
+    if (static_cast<size_t>(position) < shared_chunk.size() && shared_chunk[position].first == key) {
+        return false;
+    }
+    Chunk& chunk = MakeChunkUnique(chunks_[index]);
+    chunk.emplace(chunk.begin() + position, key, std::move(value));
+    first_keys_[index] = chunk.front().first;
+    ++size_;
+
+    if (chunk.size() > MAX_CHUNK_SIZE) {
+        auto second_half = std::make_shared<Chunk>(chunk.begin() + chunk.size() / 2, chunk.end());
+        chunk.erase(chunk.begin() + chunk.size() / 2, chunk.end());
+        first_keys_.insert(first_keys_.begin() + index + 1, second_half->front().first);
+        chunks_.insert(chunks_.begin() + index + 1, std::move(second_half));
+    }
+    return true;
+}
+
+/*! \fn ChunkedMap::Erase
+ *  \b   \b :   \n
+ *  \b   \b :  .   ,     \n
+ *  \b  \b :  \n
+ *  \param[in] key  \n
+ *  \return true,    \n
+ */
+template <typename Key, typename Value>
+bool ChunkedMap<Key, Value>::Erase(const Key& key) {
+    if (Find(key) == nullptr) {
+        return false;
+    }
+
+    const size_t index = FindChunk(key);
+    Chunk& chunk = MakeChunkUnique(chunks_[index]);
+    chunk.erase(std::lower_bound(chunk.begin(), chunk.end(), key,
+        [](const Entry& entry, const Key& value) {return entry.first < value;}));
+    --size_;
+    if (chunk.empty()) {
+        chunks_.erase(chunks_.begin() + index);
+        first_keys_.erase(first_keys_.begin() + index);
+        return true;
+    }
+    first_keys_[index] = chunk.front().first;
+    if (chunk.size() < MIN_CHUNK_SIZE && chunks_.size() > 1) {
+        MergeChunk(index + 1 < chunks_.size() ? index : index - 1);
+    }
+    return true;
+}
+
+template <typename Key, typename Value>
+typename ChunkedMap<Key, Value>::Iterator ChunkedMap<Key, Value>::begin() const {
+    return Iterator(this, 0, 0);
+}
+
+template <typename Key, typename Value>
+typename ChunkedMap<Key, Value>::Iterator ChunkedMap<Key, Value>::end() const {
+    return Iterator(this, chunks_.size(), 0);
+}
+
+template <typename Key, typename Value>
+typename ChunkedMap<Key, Value>::KeyIterator ChunkedMap<Key, Value>::BeginKeys() const {
+    return KeyIterator(this, 0, 0);
+}
+
+template <typename Key, typename Value>
+typename ChunkedMap<Key, Value>::KeyIterator ChunkedMap<Key, Value>::EndKeys() const {
+    return KeyIterator(this, chunks_.size(), 0);
+}
+
+/*     ,        */
+template <typename Key, typename Value>
+size_t ChunkedMap<Key, Value>::GetMemoryBytes() const {
+    size_t bytes = chunks_.capacity() * sizeof(std::shared_ptr<Chunk>) + first_keys_.capacity() * sizeof(Key);
+    for (const auto& chunk : chunks_) {
+        bytes += sizeof(Chunk) + chunk->capacity() * sizeof(Entry);
+    }
+    return bytes;
+}
+
+/* ,   :         */
+template <typename Key, typename Value>
+size_t ChunkedMap<Key, Value>::FindChunk(const Key& key) const {
+    const auto iterator = std::upper_bound(first_keys_.begin(), first_keys_.end(), key);
+    return iterator == first_keys_.begin() ? 0 : iterator - first_keys_.begin() - 1;
+}
+
+/*! \fn ChunkedMap::MergeChunk
+ *  \b   \b :   \n
+ *  \b   \b :    .     ,
+ *                           \n
+ *  \b  \b :    \n
+ *  \param[in] chunk   \n
+ *  \return  \n
+ */
+template <typename Key, typename Value>
+void ChunkedMap<Key, Value>::MergeChunk(size_t chunk) {
+    Chunk& first = MakeChunkUnique(chunks_[chunk]);
+    const Chunk& second = *chunks_[chunk + 1];
+    if (first.size() + second.size() <= MAX_CHUNK_SIZE) {
+        first.insert(first.end(), second.begin(), second.end());
+        chunks_.erase(chunks_.begin() + chunk + 1);
+        first_keys_.erase(first_keys_.begin() + chunk + 1);
+        return;
+    }
+    Chunk entries = first;
+    entries.insert(entries.end(), second.begin(), second.end());
+    const size_t middle = entries.size() / 2;
+    first.assign(entries.begin(), entries.begin() + middle);
+    chunks_[chunk + 1] = std::make_shared<Chunk>(entries.begin() + middle, entries.end());
+    first_keys_[chunk + 1] = chunks_[chunk + 1]->front().first;
+}
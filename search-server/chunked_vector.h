@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*! \fn MakeChunkUnique
+ *  \b   \b :   \n
+ *  \b   \b :  ,    ,  :
+ *                      ,     ,   .
+ *                            \n
+ *  \b  \b :  ,  ,     .
+ *                               \n
+ *  \param[in,out] chunk  \n
+ *  \return ,     \n
+ */
+template <typename Chunk>
+Chunk& MakeChunkUnique(std::shared_ptr<Chunk>& chunk) {
+    if (chunk.use_count() != 1) {
+        chunk = std::make_shared<Chunk>(*chunk);
+    }
+    else {
+        /*       :      */
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *chunk;
+}
+
+/*     CHUNK_SIZE ,    . 
+       ,       , 
+      .    N   N / CHUNK_SIZE , 
+     -       .    
+     .     ,     */
+template <typename T>
+class ChunkedVector {
+public:
+    static constexpr size_t CHUNK_SHIFT = 10;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+
+    size_t size() const;
+    bool empty() const;
+    const T& operator[](size_t index) const;
+    const T& at(size_t index) const;
+    const T& back() const;
+    T& GetMutable(size_t index);
+    void push_back(T value);
+    void clear();
+    size_t GetMemoryBytes() const;
+
+private:
+    using Chunk = std::array<T, CHUNK_SIZE>;
+
+    std::vector<std::shared_ptr<Chunk>> chunks_;
+    size_t size_ = 0;
+};
+
+template <typename T>
+size_t ChunkedVector<T>::size() const {
+    return size_;
+}
+
+template <typename T>
+bool ChunkedVector<T>::empty() const {
+    return size_ == 0;
+}
+
+template <typename T>
+const T& ChunkedVector<T>::operator[](size_t index) const {
+    return (*chunks_[index >> CHUNK_SHIFT])[index & (CHUNK_SIZE - 1)];
+}
+
+template <typename T>
+const T& ChunkedVector<T>::at(size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("ChunkedVector index is out of range");
+    }
+    return (*this)[index];
+}
+
+template <typename T>
+const T& ChunkedVector<T>::back() const {
+    return (*this)[size_ - 1];
+}
+
+/*! \fn ChunkedVector::GetMutable
+ *  \b   \b :   \n
+ *  \b   \b :     .  ,   
+ *                      ,   \n
+ *  \b  \b :       \n
+ *  \param[in] index   \n
+ *  \return    \n
+ */
+template <typename T>
+T& ChunkedVector<T>::GetMutable(size_t index) {
+    if (index >= size_) {
+        throw std::out_of_range("ChunkedVector index is out of range");
+    }
+    return MakeChunkUnique(chunks_[index >> CHUNK_SHIFT])[index & (CHUNK_SIZE - 1)];
+}
+
+template <typename T>
+void ChunkedVector<T>::push_back(T value) {
+    if ((size_ & (CHUNK_SIZE - 1)) == 0) {
+        chunks_.push_back(std::make_shared<Chunk>());
+    }
+    MakeChunkUnique(chunks_.back())[size_ & (CHUNK_SIZE - 1)] = std::move(value);
+    ++size_;
+}
+
+template <typename T>
+void ChunkedVector<T>::clear() {
+    chunks_.clear();
+    size_ = 0;
+}
+
+/*     ,        */
+template <typename T>
+size_t ChunkedVector<T>::GetMemoryBytes() const {
+    return chunks_.capacity() * sizeof(std::shared_ptr<Chunk>) + chunks_.size() * sizeof(Chunk);
+}
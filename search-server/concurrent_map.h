@@ -1,55 +1,228 @@
 #pragma once
 
-template <typename Key, typename Value>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*   .    ,  , 
+     ,     */
+const size_t CACHE_LINE_SIZE = 64;
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
 class ConcurrentMap {
 public:
-    static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys");
+    static_assert(std::is_trivially_copyable_v<Value>, "ConcurrentMap stores values in std::atomic");
 
-    struct Bucket {
-        std::map<Key, Value> map;
-        std::mutex mutex;
-    };
+    explicit ConcurrentMap(size_t stripe_count, Hash hash = Hash())
+        : hash_(std::move(hash))
+        , stripes_(stripe_count > 0 ? stripe_count : 1)
+    {
+    }
 
-    struct Access {
-        std::lock_guard<std::mutex> guard;
-        Value& ref_to_value;
-    };
+    /*    .     
+          ,    -   */
+    void Add(const Key& key, Value delta) {
+        const uint64_t hash = ComputeHash(key);
+        Stripe& stripe = GetStripe(hash);
 
-    explicit ConcurrentMap(size_t bucket_count)
-        : buckets_(bucket_count)
-    {
+        {
+            std::shared_lock guard(stripe.mutex);
+            const size_t index = FindSlot(stripe, key, hash);
+            if (index != NOT_FOUND) {
+                AtomicAdd(stripe.slots[index].value, delta);
+                return;
+            }
+        }
+
+        std::unique_lock guard(stripe.mutex);
+        AtomicAdd(stripe.slots[InsertSlot(stripe, key, hash)].value, delta);
+    }
+
+    /*     function(Value&)     */
+    template <typename Function>
+    void Update(const Key& key, Function function) {
+        const uint64_t hash = ComputeHash(key);
+        Stripe& stripe = GetStripe(hash);
+
+        std::unique_lock guard(stripe.mutex);
+        std::atomic<Value>& atomic_value = stripe.slots[InsertSlot(stripe, key, hash)].value;
+        Value value = atomic_value.load(std::memory_order_relaxed);
+        function(value);
+        atomic_value.store(value, std::memory_order_relaxed);
+    }
+
+    /*  .   ,    */
+    bool Erase(const Key& key) {
+        const uint64_t hash = ComputeHash(key);
+        Stripe& stripe = GetStripe(hash);
+
+        std::unique_lock guard(stripe.mutex);
+        const size_t index = FindSlot(stripe, key, hash);
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        stripe.slots[index].state = SlotState::ERASED;
+        --stripe.size;
+        return true;
     }
 
-    Access operator[](const Key& key) {
-        size_t index = static_cast<uint64_t>(key) % buckets_.size();
-        return { std::lock_guard(buckets_[index].mutex), buckets_[index].map[key] };
+    /*    -    .     */
+    std::vector<std::pair<Key, Value>> Extract() {
+        std::vector<std::pair<Key, Value>> result;
+
+        for (auto& stripe : stripes_) {
+            std::unique_lock guard(stripe.mutex);
+            for (auto& slot : stripe.slots) {
+                if (slot.state == SlotState::FULL) {
+                    result.emplace_back(std::move(slot.key), slot.value.load(std::memory_order_relaxed));
+                }
+            }
+            std::vector<Slot>().swap(stripe.slots);
+            stripe.size = 0;
+            stripe.used = 0;
+        }
+        return result;
     }
 
     std::map<Key, Value> BuildOrdinaryMap() {
         std::map<Key, Value> result;
 
         /*   */
-        for (auto& bucket : buckets_)
-        {
-            std::lock_guard g(bucket.mutex);
-            for (const auto& item : bucket.map) {
-                result[item.first] = item.second;
+        for (auto& stripe : stripes_) {
+            std::shared_lock guard(stripe.mutex);
+            for (const auto& slot : stripe.slots) {
+                if (slot.state == SlotState::FULL) {
+                    result.emplace(slot.key, slot.value.load(std::memory_order_relaxed));
+                }
             }
         }
         return result;
     }
 
-    void Erase(const Key& key) {
-        for (auto& bucket : buckets_)
-        {
-            if (bucket.map.count(key))
-            {
-                std::lock_guard g(bucket.mutex);
-                bucket.map.erase(key);
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    enum class SlotState : uint8_t {
+        EMPTY,
+        FULL,
+        ERASED,
+    };
+
+    struct Slot {
+        SlotState state = SlotState::EMPTY;
+        Key key{};
+        std::atomic<Value> value{};
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Stripe {
+        std::shared_mutex mutex;
+        std::vector<Slot> slots; /*!<  ,  -   */
+        size_t size = 0;         /*!<    */
+        size_t used = 0;         /*!<      */
+    };
+
+    Hash hash_;
+    std::vector<Stripe> stripes_;
+
+    uint64_t ComputeHash(const Key& key) const {
+        /*   (splitmix64): std::hash    -   */
+        uint64_t hash = static_cast<uint64_t>(hash_(key));
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+    Stripe& GetStripe(uint64_t hash) {
+        /*    ,  -    */
+        return stripes_[(hash >> 32) % stripes_.size()];
+    }
+
+    static size_t FindSlot(const Stripe& stripe, const Key& key, uint64_t hash) {
+        if (stripe.slots.empty()) {
+            return NOT_FOUND;
+        }
+
+        const size_t mask = stripe.slots.size() - 1;
+        for (size_t index = hash & mask; ; index = (index + 1) & mask) {
+            const Slot& slot = stripe.slots[index];
+            if (slot.state == SlotState::EMPTY) {
+                return NOT_FOUND;
+            }
+            if (slot.state == SlotState::FULL && slot.key == key) {
+                return index;
             }
         }
     }
 
-private:
-    std::vector<Bucket> buckets_;
+    size_t InsertSlot(Stripe& stripe, const Key& key, uint64_t hash) {
+        const size_t index = FindSlot(stripe, key, hash);
+        if (index != NOT_FOUND) {
+            return index;
+        }
+
+        /*         3/4 */
+        if ((stripe.used + 1) * 4 > stripe.slots.size() * 3) {
+            Rehash(stripe);
+        }
+        const size_t mask = stripe.slots.size() - 1;
+        size_t free_index = hash & mask;
+        while (stripe.slots[free_index].state == SlotState::FULL) {
+            free_index = (free_index + 1) & mask;
+        }
+        Slot& slot = stripe.slots[free_index];
+        if (slot.state == SlotState::EMPTY) {
+            ++stripe.used;
+        }
+        slot.state = SlotState::FULL;
+        slot.key = key;
+        slot.value.store(Value{}, std::memory_order_relaxed);
+        ++stripe.size;
+        return free_index;
+    }
+
+    void Rehash(Stripe& stripe) {
+        size_t capacity = MIN_CAPACITY;
+        while ((stripe.size + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+
+        std::vector<Slot> slots(capacity);
+        const size_t mask = capacity - 1;
+        for (auto& slot : stripe.slots) {
+            if (slot.state != SlotState::FULL) {
+                continue;
+            }
+            size_t index = ComputeHash(slot.key) & mask;
+            while (slots[index].state == SlotState::FULL) {
+                index = (index + 1) & mask;
+            }
+            slots[index].state = SlotState::FULL;
+            slots[index].key = std::move(slot.key);
+            slots[index].value.store(slot.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        stripe.slots.swap(slots);
+        stripe.used = stripe.size;
+    }
+
+    static void AtomicAdd(std::atomic<Value>& atomic_value, Value delta) {
+        if constexpr (std::is_integral_v<Value>) {
+            atomic_value.fetch_add(delta, std::memory_order_relaxed);
+        }
+        else {
+            Value expected = atomic_value.load(std::memory_order_relaxed);
+            while (!atomic_value.compare_exchange_weak(expected, expected + delta,
+                std::memory_order_relaxed)) {
+            }
+        }
+    }
 };
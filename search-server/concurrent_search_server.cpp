@@ -0,0 +1,89 @@
+#include <execution>
+
+#include "concurrent_search_server.h"
+
+ConcurrentSearchServer::ConcurrentSearchServer(SearchServer search_server)
+    : search_server_(std::move(search_server))
+    , snapshot_(std::make_shared<const SearchServer>(search_server_))
+{
+}
+
+/*! \fn ConcurrentSearchServer::GetSnapshot
+ *  \b   \b :   \n
+ *  \b   \b :    .    ,
+ *                          ,       
+ *                        \n
+ *  \b  \b : ,    ,     \n
+ *  \return    \n
+ */
+ConcurrentSearchServer::Snapshot ConcurrentSearchServer::GetSnapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+/*! \fn ConcurrentSearchServer::FindTopDocumentsAsync
+ *  \b   \b :   \n
+ *  \b   \b :          .
+ *                         ,    ThreadPool::GetDefault. 
+ *                        ,     
+ *                         .     
+ *                        ,     -  \n
+ *  \b  \b :      future.   
+ *                       ,     \n
+ *  \param[in] raw_query   \n
+ *  \param[in] status   \n
+ *  \param[in] options  ,       \n
+ *  \return   \n
+ */
+std::future<std::vector<Document>> ConcurrentSearchServer::FindTopDocumentsAsync(std::string raw_query,
+                                                                                 DocumentStatus status,
+                                                                                 SearchOptions options) const
+{
+    Snapshot snapshot = GetSnapshot();
+    const std::shared_ptr<ThreadPool> thread_pool =
+        snapshot->GetThreadPool() ? snapshot->GetThreadPool() : ThreadPool::GetDefault();
+    return thread_pool->Submit([snapshot = std::move(snapshot), raw_query = std::move(raw_query), status, options]() {
+        if (options.cancellation.IsCancelled()) {
+            return std::vector<Document>{};
+        }
+        return snapshot->FindTopDocuments(std::execution::seq, raw_query, status, options);
+    });
+}
+
+void ConcurrentSearchServer::AddDocument(int document_id,
+                                         const std::string_view document,
+                                         DocumentStatus status,
+                                         const std::vector<int>& ratings)
+{
+    Update([&](SearchServer& search_server) {
+        search_server.AddDocument(document_id, document, status, ratings);
+    });
+}
+
+void ConcurrentSearchServer::AddDocuments(const std::vector<RawDocument>& documents) {
+    Update([&documents](SearchServer& search_server) {
+        search_server.AddDocuments(std::execution::par, documents);
+    });
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    Update([document_id](SearchServer& search_server) {
+        search_server.RemoveDocument(document_id);
+    });
+}
+
+void ConcurrentSearchServer::RemoveDocuments(const std::vector<int>& document_ids) {
+    Update([&document_ids](SearchServer& search_server) {
+        search_server.RemoveDocuments(document_ids);
+    });
+}
+
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> ConcurrentSearchServer::MatchDocuments(
+    const std::string& raw_query,
+    const std::vector<int>& document_ids) const
+{
+    return GetSnapshot()->MatchDocuments(raw_query, document_ids);
+}
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    return GetSnapshot()->GetDocumentCount();
+}
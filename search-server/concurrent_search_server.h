@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+
+/*      .     
+          ,    
+         .     
+   ,   ,        ,
+      ,    .    
+     Update.
+        std::atomic_load/atomic_store  shared_ptr, 
+    libstdc++   -      
+   (_Sp_locker)    :       
+   ,     */
+class ConcurrentSearchServer {
+public:
+    using Snapshot = std::shared_ptr<const SearchServer>;
+
+    explicit ConcurrentSearchServer(SearchServer search_server);
+
+    Snapshot GetSnapshot() const;
+    void AddDocument(int document_id,
+                     const std::string_view document,
+                     DocumentStatus status,
+                     const std::vector<int>& ratings);
+    void AddDocuments(const std::vector<RawDocument>& documents);
+    void RemoveDocument(int document_id);
+    void RemoveDocuments(const std::vector<int>& document_ids);
+    template <typename Function>
+    void Update(Function function);
+
+    template <typename... Args>
+    std::vector<Document> FindTopDocuments(Args&&... args) const;
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query,
+                                                             DocumentStatus status = DocumentStatus::ACTUAL,
+                                                             SearchOptions options = {}) const;
+    template <typename... Args>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(Args&&... args) const;
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> MatchDocuments(
+        const std::string& raw_query,
+        const std::vector<int>& document_ids) const;
+    int GetDocumentCount() const;
+
+private:
+    std::mutex writer_mutex_;    /*!<  search_server_ */
+    SearchServer search_server_; /*!<   */
+    Snapshot snapshot_;          /*!<  ,   std::atomic_load/atomic_store */
+};
+
+/*! \fn ConcurrentSearchServer::Update
+ *  \b   \b :   \n
+ *  \b   \b :       .  
+ *                      ,     . ,  ,
+ *                         ,    
+ *                           \n
+ *  \b  \b :    ,     , 
+ *                       SearchServer,       \n
+ *  \param[in] function ,  SearchServer& \n
+ *  \return  \n
+ */
+template <typename Function>
+void ConcurrentSearchServer::Update(Function function) {
+    std::lock_guard guard(writer_mutex_);
+    function(search_server_);
+    std::atomic_store(&snapshot_, Snapshot(std::make_shared<const SearchServer>(search_server_)));
+}
+
+template <typename... Args>
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(Args&&... args) const {
+    return GetSnapshot()->FindTopDocuments(std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+std::tuple<std::vector<std::string_view>, DocumentStatus> ConcurrentSearchServer::MatchDocument(
+    Args&&... args) const
+{
+    return GetSnapshot()->MatchDocument(std::forward<Args>(args)...);
+}
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "index_file.h"
+
+namespace {
+
+const char INDEX_FILE_MAGIC[8] = { 'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+/*     ,       */
+const uint64_t SECTION_ALIGNMENT = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint32_t section_count;
+    uint32_t pointer_size;
+    uint64_t checksum; /*!<    (  checksum)    */
+};
+
+struct FileSection {
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t count;
+    uint64_t checksum; /*!<     */
+};
+
+uint64_t AlignOffset(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+uint64_t ComputeHeaderChecksum(FileHeader header, const FileSection* sections) {
+    header.checksum = 0;
+    const uint64_t header_checksum = ComputeChecksum(reinterpret_cast<const char*>(&header), sizeof(header));
+    return header_checksum ^ ComputeChecksum(reinterpret_cast<const char*>(sections),
+        header.section_count * sizeof(FileSection));
+}
+
+} // namespace
+
+/*! \fn ComputeChecksum
+ *  \b   \b :   \n
+ *  \b   \b :   FNV-1a,   8-  \n
+ *  \b  \b :    \n
+ *  \param[in] data  \n
+ *  \param[in] size     \n
+ *  \return   \n
+ */
+uint64_t ComputeChecksum(const char* data, size_t size) {
+    static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    uint64_t checksum = FNV_OFFSET_BASIS ^ size;
+    size_t position = 0;
+    for (; position + sizeof(uint64_t) <= size; position += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + position, sizeof(word));
+        checksum = (checksum ^ word) * FNV_PRIME;
+    }
+    for (; position < size; ++position) {
+        checksum = (checksum ^ static_cast<unsigned char>(data[position])) * FNV_PRIME;
+    }
+    return checksum;
+}
+
+/*! \fn AreValidOffsets
+ *  \b   \b :   \n
+ *  \b   \b :       :   ,
+ *                        ,     \n
+ *  \b  \b :     \n
+ *  \param[in] offsets ,      \n
+ *  \param[in] end   \n
+ *  \return true,         \n
+ */
+bool AreValidOffsets(Span<uint64_t> offsets, uint64_t end) {
+    return !offsets.empty() && offsets[0] == 0 && offsets.back() == end &&
+        std::is_sorted(offsets.begin(), offsets.end());
+}
+
+/*! \fn IndexFileWriter::Write
+ *  \b   \b :   \n
+ *  \b   \b :   : ,      \n
+ *  \b  \b :         ,
+ *                          \n
+ *  \param[in] path    \n
+ *  \return  \n
+ */
+void IndexFileWriter::Write(const std::string& path) const {
+    std::vector<FileSection> file_sections;
+    uint64_t offset = AlignOffset(sizeof(FileHeader) + sections_.size() * sizeof(FileSection));
+    for (const Section& section : sections_) {
+        const uint64_t size = section.count * section.element_size;
+        file_sections.push_back({ static_cast<uint32_t>(section.id), section.element_size, offset,
+            section.count, ComputeChecksum(section.data.data(), size) });
+        offset = AlignOffset(offset + size);
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.version = INDEX_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.file_size = offset;
+    header.section_count = static_cast<uint32_t>(file_sections.size());
+    header.pointer_size = sizeof(void*);
+    header.checksum = ComputeHeaderChecksum(header, file_sections.data());
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+    static const char padding[SECTION_ALIGNMENT] = {};
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(file_sections.data()), file_sections.size() * sizeof(FileSection));
+    uint64_t position = sizeof(FileHeader) + file_sections.size() * sizeof(FileSection);
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        output.write(padding, file_sections[i].offset - position);
+        output.write(sections_[i].data.data(), sections_[i].data.size());
+        position = file_sections[i].offset + sections_[i].count * sections_[i].element_size;
+    }
+    output.write(padding, header.file_size - position);
+    if (!output) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+/*! \fn IndexFileReader::IndexFileReader
+ *  \b   \b :   \n
+ *  \b   \b :       .  
+ *                       ,        \n
+ *  \b  \b :  \n
+ *  \param[in] file   \n
+ *  \param[in] verify_checksums      \n
+ */
+IndexFileReader::IndexFileReader(std::shared_ptr<const MappedFile> file, bool verify_checksums)
+    : file_(std::move(file))
+    , sections_(static_cast<size_t>(IndexSection::COUNT))
+{
+    const char* data = file_->GetData();
+    const size_t size = file_->GetSize();
+
+    FileHeader header;
+    if (size < sizeof(header)) {
+        throw std::invalid_argument("Index file is too small");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::invalid_argument("File is not a search index");
+    }
+    if (header.version != INDEX_FILE_VERSION || header.byte_order != BYTE_ORDER_MARK ||
+        header.pointer_size != sizeof(void*)) {
+        throw std::invalid_argument("Index file was written by an incompatible version or platform");
+    }
+    if (header.file_size != size ||
+        (size - sizeof(header)) / sizeof(FileSection) < header.section_count) {
+        throw std::invalid_argument("Index file is truncated");
+    }
+
+    const FileSection* file_sections = reinterpret_cast<const FileSection*>(data + sizeof(header));
+    if (ComputeHeaderChecksum(header, file_sections) != header.checksum) {
+        throw std::invalid_argument("Index file header checksum mismatch");
+    }
+
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        const FileSection& file_section = file_sections[i];
+        if (file_section.id >= sections_.size() || file_section.offset % SECTION_ALIGNMENT != 0 ||
+            file_section.element_size == 0 || file_section.offset > size ||
+            (size - file_section.offset) / file_section.element_size < file_section.count) {
+            throw std::invalid_argument("Index file section table is corrupted");
+        }
+        const char* section_data = data + file_section.offset;
+        if (verify_checksums && ComputeChecksum(section_data,
+            file_section.count * file_section.element_size) != file_section.checksum) {
+            throw std::invalid_argument("Index file section checksum mismatch");
+        }
+        sections_[file_section.id] = { file_section.element_size, section_data, file_section.count };
+    }
+}
+
+const std::shared_ptr<const MappedFile>& IndexFileReader::GetFile() const {
+    return file_;
+}
+
+const IndexFileReader::Section& IndexFileReader::GetSection(IndexSection section, size_t element_size) const {
+    const Section& view = sections_.at(static_cast<size_t>(section));
+    if (view.data == nullptr || view.element_size != element_size) {
+        throw std::invalid_argument("Index file section is missing");
+    }
+    return view;
+}
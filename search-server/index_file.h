@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.h"
+
+const uint32_t INDEX_FILE_VERSION = 4;
+
+/*  ,    */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+
+    Span(const T* data, size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    Span(const std::vector<T>& values)
+        : data_(values.data())
+        , size_(values.size())
+    {
+    }
+
+    const T* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+
+    const T* end() const {
+        return data_ + size_;
+    }
+
+    const T& operator[](size_t index) const {
+        return data_[index];
+    }
+
+    const T& back() const {
+        return data_[size_ - 1];
+    }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/*    */
+enum class IndexSection : uint32_t {
+    STOP_WORD_CHARS,
+    STOP_WORD_OFFSETS,
+    TERM_CHARS,
+    TERM_OFFSETS,
+    SORTED_TERM_IDS,
+    DOCUMENT_FREQS,
+    SEGMENT_TERM_IDS,
+    SEGMENT_OFFSETS,
+    SEGMENT_BLOCK_OFFSETS,
+    SEGMENT_MAX_TERM_FREQS,
+    SEGMENT_BLOCKS,
+    SEGMENT_DATA,
+    SEGMENT_INVERSE_DOCUMENT_LENGTHS,
+    TOTAL_DOCUMENT_LENGTH, /*!<  :        */
+    DOCUMENTS,
+    SORTED_DOCUMENT_IDS,
+    SORTED_INTERNAL_IDS,
+    TEXT_CHARS,
+    TEXT_OFFSETS,
+    FORWARD_OFFSETS,
+    FORWARD_TERM_IDS,
+    FORWARD_TERM_FREQS,
+    COUNT,
+};
+
+uint64_t ComputeChecksum(const char* data, size_t size);
+bool AreValidOffsets(Span<uint64_t> offsets, uint64_t end);
+
+class IndexFileWriter {
+public:
+    template <typename T>
+    void AddSection(IndexSection section, Span<T> values);
+    void Write(const std::string& path) const;
+
+private:
+    struct Section {
+        IndexSection id;
+        uint32_t element_size;
+        std::vector<char> data;
+        uint64_t count;
+    };
+
+    std::vector<Section> sections_;
+};
+
+class IndexFileReader {
+public:
+    IndexFileReader(std::shared_ptr<const MappedFile> file, bool verify_checksums);
+
+    template <typename T>
+    Span<T> GetSection(IndexSection section) const;
+    const std::shared_ptr<const MappedFile>& GetFile() const;
+
+private:
+    struct Section {
+        uint32_t element_size = 0;
+        const char* data = nullptr;
+        uint64_t count = 0;
+    };
+
+    std::shared_ptr<const MappedFile> file_;
+    std::vector<Section> sections_; /*!<    */
+
+    const Section& GetSection(IndexSection section, size_t element_size) const;
+};
+
+/*! \fn IndexFileWriter::AddSection
+ *  \b   \b :   \n
+ *  \b   \b :     .   \n
+ *  \b  \b :  \n
+ *  \param[in] section   \n
+ *  \param[in] values   \n
+ *  \return  \n
+ */
+template <typename T>
+void IndexFileWriter::AddSection(IndexSection section, Span<T> values) {
+    static_assert(std::is_trivially_copyable_v<T>, "Index file sections are copied byte by byte");
+
+    const char* data = reinterpret_cast<const char*>(values.data());
+    sections_.push_back({ section, static_cast<uint32_t>(sizeof(T)),
+        std::vector<char>(data, data + values.size() * sizeof(T)), values.size() });
+}
+
+/*! \fn IndexFileReader::GetSection
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :  ,     \n
+ *  \param[in] section   \n
+ *  \return   \n
+ */
+template <typename T>
+Span<T> IndexFileReader::GetSection(IndexSection section) const {
+    static_assert(std::is_trivially_copyable_v<T>, "Index file sections are copied byte by byte");
+
+    const Section& view = GetSection(section, sizeof(T));
+    return { reinterpret_cast<const T*>(view.data), static_cast<size_t>(view.count) };
+}
@@ -0,0 +1,1244 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+#include "inverted_index.h"
+
+namespace {
+
+int GetBitWidth(uint32_t value) {
+    int width = 0;
+    for (; value != 0; value >>= 1) {
+        ++width;
+    }
+    return width;
+}
+
+/*    ,  ReadBits  WriteBits   8 
+      */
+const size_t PACKED_DATA_PADDING = sizeof(uint64_t);
+
+void WriteBits(uint8_t* data, uint64_t bit_position, uint32_t value) {
+    uint64_t word;
+    std::memcpy(&word, data + bit_position / 8, sizeof(word));
+    word |= static_cast<uint64_t>(value) << (bit_position % 8);
+    std::memcpy(data + bit_position / 8, &word, sizeof(word));
+}
+
+uint32_t ReadBits(const uint8_t* data, uint64_t bit_position, int width) {
+    uint64_t word;
+    std::memcpy(&word, data + bit_position / 8, sizeof(word));
+    return static_cast<uint32_t>((word >> (bit_position % 8)) & ((uint64_t(1) << width) - 1));
+}
+
+/*   :   ,  size - 1   size  */
+uint64_t GetPackedBlockSize(size_t size, int delta_width, int count_width) {
+    const uint64_t bit_count = (size - 1) * delta_width + size * count_width;
+    return 2 + (bit_count + 7) / 8;
+}
+
+/*      ,    */
+uint64_t ComputeDocumentLength(double inverse_document_length) {
+    return inverse_document_length == 0.0 ? 0 : static_cast<uint64_t>(std::llround(1.0 / inverse_document_length));
+}
+
+} // namespace
+
+/*! \fn InvertedIndex::PostingIterator::PostingIterator
+ *  \b   \b :   \n
+ *  \b   \b :         
+ *                      first_document_id.        \n
+ *  \b  \b :  \n
+ *  \param[in] postings   \n
+ *  \param[in] first_document_id     \n
+ *  \param[in] last_document_id      \n
+ */
+InvertedIndex::PostingIterator::PostingIterator(const Postings& postings,
+                                                int first_document_id,
+                                                int last_document_id)
+    : postings_(postings)
+    , last_document_id_(last_document_id)
+{
+    const PostingBlock* block = std::lower_bound(postings_.blocks, postings_.blocks + postings_.block_count,
+        first_document_id, [](const PostingBlock& value, int document_id) {
+            return value.last_document_id < document_id;
+        });
+    LoadBlock(block - postings_.blocks);
+    SkipTo(first_document_id);
+}
+
+/*! \fn InvertedIndex::PostingIterator::SkipTo
+ *  \b   \b :   \n
+ *  \b   \b :         document_id.
+ *                      ,     document_id, 
+ *                        \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \return  \n
+ */
+void InvertedIndex::PostingIterator::SkipTo(int document_id) {
+    if (IsEnd() || document_ids_[position_] >= document_id) {
+        return;
+    }
+    if (postings_.blocks[block_].last_document_id < document_id) {
+        const PostingBlock* block = std::lower_bound(postings_.blocks + block_ + 1,
+            postings_.blocks + postings_.block_count, document_id,
+            [](const PostingBlock& value, int id) {
+                return value.last_document_id < id;
+            });
+        LoadBlock(block - postings_.blocks);
+        if (IsEnd()) {
+            return;
+        }
+    }
+    position_ = std::lower_bound(document_ids_ + position_, document_ids_ + block_size_, document_id) -
+        document_ids_;
+    if (document_ids_[position_] >= last_document_id_) {
+        block_ = postings_.block_count;
+    }
+}
+
+/*! \fn InvertedIndex::PostingIterator::LoadBlock
+ *  \b   \b :   \n
+ *  \b   \b :  :      , 
+ *                             
+ *                       ,   ,      \n
+ *  \b  \b :  \n
+ *  \param[in] block   \n
+ *  \return  \n
+ */
+void InvertedIndex::PostingIterator::LoadBlock(size_t block) {
+    block_ = block;
+    if (block_ >= postings_.block_count ||
+        postings_.blocks[block_].first_document_id >= last_document_id_) {
+        block_ = postings_.block_count;
+        return;
+    }
+
+    const size_t first_position = block_ * BLOCK_SIZE;
+    block_size_ = std::min(BLOCK_SIZE, postings_.size - first_position);
+    position_ = 0;
+    if (postings_.data == nullptr) {
+        std::copy_n(postings_.document_ids + first_position, block_size_, document_ids_);
+        std::copy_n(postings_.counts + first_position, block_size_, counts_);
+        return;
+    }
+
+    const uint8_t* data = postings_.data + postings_.blocks[block_].data_offset;
+    const int delta_width = data[0];
+    const int count_width = data[1];
+    const uint8_t* bits = data + 2;
+    uint64_t bit_position = 0;
+    int document_id = postings_.blocks[block_].first_document_id;
+    document_ids_[0] = document_id;
+    for (size_t i = 1; i < block_size_; ++i, bit_position += delta_width) {
+        document_id += static_cast<int>(ReadBits(bits, bit_position, delta_width)) + 1;
+        document_ids_[i] = document_id;
+    }
+    for (size_t i = 0; i < block_size_; ++i, bit_position += count_width) {
+        counts_[i] = static_cast<int>(ReadBits(bits, bit_position, count_width)) + 1;
+    }
+}
+
+double InvertedIndex::MemoryStats::GetBytesPerPosting() const {
+    if (posting_count == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(dictionary_bytes + posting_bytes) / posting_count;
+}
+
+InvertedIndex::Postings InvertedIndex::Segment::GetPostings(int term_id) const {
+    const auto iterator = std::lower_bound(term_ids.begin(), term_ids.end(), term_id);
+    if (iterator == term_ids.end() || *iterator != term_id) {
+        return {};
+    }
+    return GetTermPostings(iterator - term_ids.begin());
+}
+
+InvertedIndex::Postings InvertedIndex::Segment::GetTermPostings(size_t term_index) const {
+    Postings postings;
+    postings.blocks = blocks.data() + block_offsets[term_index];
+    postings.block_count = block_offsets[term_index + 1] - block_offsets[term_index];
+    postings.size = offsets[term_index + 1] - offsets[term_index];
+    postings.max_term_freq = max_term_freqs[term_index];
+    postings.data = data.data();
+    postings.inverse_document_lengths = inverse_document_lengths.data();
+    postings.first_document_id = first_document_id;
+    return postings;
+}
+
+/*! \fn InvertedIndex::Segment::IsValid
+ *  \b   \b :   \n
+ *  \b   \b :     :      ,
+ *                              ,  ,
+ *                          ,     
+ *                       ,      
+ *                          \n
+ *  \b  \b :    .  
+ *                       ,      \n
+ *  \param[in] term_count    \n
+ *  \return true,         \n
+ */
+bool InvertedIndex::Segment::IsValid(size_t term_count) const {
+    static const int MAX_BIT_WIDTH = 32;
+
+    /*           */
+    if ((offsets.size() != term_ids.size() + 1 && !(term_ids.empty() && offsets.empty())) ||
+        block_offsets.size() != offsets.size() ||
+        max_term_freqs.size() != term_ids.size() ||
+        inverse_document_lengths.size() != static_cast<size_t>(end_document_id - first_document_id) ||
+        data.size() < PACKED_DATA_PADDING) {
+        return false;
+    }
+    if (offsets.empty()) {
+        return blocks.empty();
+    }
+    if (offsets[0] != 0 || !std::is_sorted(offsets.begin(), offsets.end()) ||
+        !AreValidOffsets(block_offsets, blocks.size())) {
+        return false;
+    }
+
+    const uint64_t data_end = data.size() - PACKED_DATA_PADDING;
+    for (size_t term_index = 0; term_index < term_ids.size(); ++term_index) {
+        if (term_ids[term_index] < 0 || static_cast<size_t>(term_ids[term_index]) >= term_count ||
+            (term_index > 0 && term_ids[term_index] <= term_ids[term_index - 1])) {
+            return false;
+        }
+        const uint64_t posting_count = offsets[term_index + 1] - offsets[term_index];
+        const uint64_t first_block = block_offsets[term_index];
+        if (posting_count == 0 ||
+            block_offsets[term_index + 1] - first_block != (posting_count + BLOCK_SIZE - 1) / BLOCK_SIZE) {
+            return false;
+        }
+        int previous_document_id = first_document_id - 1;
+        for (uint64_t block = first_block; block < block_offsets[term_index + 1]; ++block) {
+            const PostingBlock& posting_block = blocks[block];
+            const uint64_t block_end = block + 1 < blocks.size() ? blocks[block + 1].data_offset : data_end;
+            if (posting_block.first_document_id <= previous_document_id ||
+                posting_block.last_document_id < posting_block.first_document_id ||
+                posting_block.last_document_id >= end_document_id ||
+                block_end > data_end || posting_block.data_offset > block_end ||
+                block_end - posting_block.data_offset < 2) {
+                return false;
+            }
+            const int delta_width = data[posting_block.data_offset];
+            const int count_width = data[posting_block.data_offset + 1];
+            const size_t size = std::min<uint64_t>(BLOCK_SIZE, posting_count - (block - first_block) * BLOCK_SIZE);
+            if (delta_width > MAX_BIT_WIDTH || count_width > MAX_BIT_WIDTH ||
+                GetPackedBlockSize(size, delta_width, count_width) != block_end - posting_block.data_offset) {
+                return false;
+            }
+            previous_document_id = posting_block.last_document_id;
+        }
+    }
+    return true;
+}
+
+size_t InvertedIndex::Segment::GetPostingCount() const {
+    return offsets.empty() ? 0 : offsets.back();
+}
+
+size_t InvertedIndex::Segment::GetMemoryBytes() const {
+    return sizeof(Segment) +
+        term_ids.size() * sizeof(int) +
+        offsets.size() * sizeof(uint64_t) +
+        block_offsets.size() * sizeof(uint64_t) +
+        max_term_freqs.size() * sizeof(double) +
+        blocks.size() * sizeof(PostingBlock) +
+        data.size() +
+        inverse_document_lengths.size() * sizeof(double);
+}
+
+InvertedIndex::SegmentBuilder::SegmentBuilder(int first_document_id,
+                                              int end_document_id,
+                                              std::vector<double> inverse_document_lengths)
+    : first_document_id(first_document_id)
+    , end_document_id(end_document_id)
+    , inverse_document_lengths(std::move(inverse_document_lengths))
+{
+}
+
+/*! \fn InvertedIndex::SegmentBuilder::AddTerm
+ *  \b   \b :   \n
+ *  \b   \b :       . 
+ *                       AddPosting  ,   FinishTerm \n
+ *  \b  \b :      \n
+ *  \param[in] term_id   \n
+ *  \return  \n
+ */
+void InvertedIndex::SegmentBuilder::AddTerm(int term_id) {
+    if (offsets.empty()) {
+        offsets.push_back(0);
+        block_offsets.push_back(0);
+    }
+    term_ids.push_back(term_id);
+    max_term_freqs.push_back(0.0);
+}
+
+void InvertedIndex::SegmentBuilder::AddPosting(int document_id, int count) {
+    block_document_ids.push_back(document_id);
+    block_counts.push_back(count);
+    if (block_document_ids.size() == BLOCK_SIZE) {
+        PackBlock();
+    }
+}
+
+/*! \fn InvertedIndex::SegmentBuilder::FinishTerm
+ *  \b   \b :   \n
+ *  \b   \b :    .   
+ *                      (  )     \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void InvertedIndex::SegmentBuilder::FinishTerm() {
+    if (!block_document_ids.empty()) {
+        PackBlock();
+    }
+    if (posting_count == offsets.back()) {
+        term_ids.pop_back();
+        max_term_freqs.pop_back();
+        return;
+    }
+    offsets.push_back(posting_count);
+    block_offsets.push_back(blocks.size());
+}
+
+/*! \fn InvertedIndex::SegmentBuilder::PackBlock
+ *  \b   \b :   \n
+ *  \b   \b :     \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void InvertedIndex::SegmentBuilder::PackBlock() {
+    PostingBlock block;
+    block.first_document_id = block_document_ids.front();
+    block.last_document_id = block_document_ids.back();
+    block.max_term_freq = 0.0;
+    block.data_offset = data.size();
+
+    uint32_t max_delta = 0;
+    uint32_t max_count = 0;
+    for (size_t i = 0; i < block_document_ids.size(); ++i) {
+        if (i > 0) {
+            max_delta = std::max<uint32_t>(max_delta, block_document_ids[i] - block_document_ids[i - 1] - 1);
+        }
+        max_count = std::max<uint32_t>(max_count, block_counts[i] - 1);
+        block.max_term_freq = std::max(block.max_term_freq, ComputeTermFreq(block_counts[i],
+            inverse_document_lengths[block_document_ids[i] - first_document_id]));
+    }
+
+    const int delta_width = GetBitWidth(max_delta);
+    const int count_width = GetBitWidth(max_count);
+    const size_t size = block_document_ids.size();
+    const size_t byte_count = GetPackedBlockSize(size, delta_width, count_width);
+    data.resize(data.size() + byte_count + PACKED_DATA_PADDING);
+    uint8_t* block_data = data.data() + block.data_offset;
+    block_data[0] = static_cast<uint8_t>(delta_width);
+    block_data[1] = static_cast<uint8_t>(count_width);
+    uint64_t bit_position = 0;
+    for (size_t i = 1; i < size; ++i, bit_position += delta_width) {
+        WriteBits(block_data + 2, bit_position, block_document_ids[i] - block_document_ids[i - 1] - 1);
+    }
+    for (size_t i = 0; i < size; ++i, bit_position += count_width) {
+        WriteBits(block_data + 2, bit_position, block_counts[i] - 1);
+    }
+    data.resize(block.data_offset + byte_count);
+
+    max_term_freqs.back() = std::max(max_term_freqs.back(), block.max_term_freq);
+    blocks.push_back(block);
+    posting_count += block_document_ids.size();
+    block_document_ids.clear();
+    block_counts.clear();
+}
+
+/*! \fn InvertedIndex::SegmentBuilder::Build
+ *  \b   \b :   \n
+ *  \b   \b :  .       \n
+ *  \b  \b :      \n
+ *  \return  \n
+ */
+std::shared_ptr<const InvertedIndex::Segment> InvertedIndex::SegmentBuilder::Build() {
+    data.resize(data.size() + PACKED_DATA_PADDING);
+    auto storage = std::make_shared<SegmentBuilder>(std::move(*this));
+
+    auto segment = std::make_shared<Segment>();
+    segment->first_document_id = storage->first_document_id;
+    segment->end_document_id = storage->end_document_id;
+    segment->term_ids = storage->term_ids;
+    segment->offsets = storage->offsets;
+    segment->block_offsets = storage->block_offsets;
+    segment->max_term_freqs = storage->max_term_freqs;
+    segment->blocks = storage->blocks;
+    segment->data = storage->data;
+    segment->inverse_document_lengths = storage->inverse_document_lengths;
+    segment->storage = std::move(storage);
+    return segment;
+}
+
+/*! \fn InvertedIndex::AddTerm
+ *  \b   \b :   \n
+ *  \b   \b :   ,       \n
+ *  \b  \b :          
+ *                       ,   \n
+ *  \param[in] word  \n
+ *  \return   \n
+ */
+int InvertedIndex::AddTerm(std::string_view word) {
+    Detach();
+    const uint64_t hash = HashTerm(word);
+    const int found_term_id = FindAddedTerm(word, hash);
+    if (found_term_id != NO_TERM) {
+        return found_term_id;
+    }
+    if (!free_term_ids_.empty()) {
+        const int term_id = free_term_ids_.back();
+        free_term_ids_.pop_back();
+        terms_.GetMutable(term_id) = term_chars_.Add(word);
+        InsertTermId(term_id, hash);
+        return term_id;
+    }
+    const int term_id = static_cast<int>(terms_.size());
+    terms_.push_back(term_chars_.Add(word));
+    InsertTermId(term_id, hash);
+    document_freqs_.push_back(0);
+    return term_id;
+}
+
+/*! \fn InvertedIndex::FindTerm
+ *  \b   \b :   \n
+ *  \b   \b :    \n
+ *  \b  \b :  \n
+ *  \param[in] word  \n
+ *  \return    NO_TERM,      \n
+ */
+int InvertedIndex::FindTerm(std::string_view word) const {
+    if (mapped_dictionary_) {
+        const Span<int>& sorted_term_ids = mapped_dictionary_->sorted_term_ids;
+        const auto iterator = std::lower_bound(sorted_term_ids.begin(), sorted_term_ids.end(), word,
+            [this](int term_id, std::string_view value) {
+                return GetTerm(term_id) < value;
+            });
+        return iterator != sorted_term_ids.end() && GetTerm(*iterator) == word ? *iterator : NO_TERM;
+    }
+    return FindAddedTerm(word, HashTerm(word));
+}
+
+uint64_t InvertedIndex::HashTerm(std::string_view word) {
+    return std::hash<std::string_view>()(word);
+}
+
+/*    ,        */
+int InvertedIndex::FindAddedTerm(std::string_view word, uint64_t hash) const {
+    const int* term_id = term_ids_by_hash_.Find(hash);
+    if (term_id != nullptr && terms_[*term_id] == word) {
+        return *term_id;
+    }
+    if (colliding_term_ids_.empty()) {
+        return NO_TERM;
+    }
+    const auto iterator = colliding_term_ids_.find(word);
+    return iterator != colliding_term_ids_.end() ? iterator->second : NO_TERM;
+}
+
+void InvertedIndex::InsertTermId(int term_id, uint64_t hash) {
+    if (!term_ids_by_hash_.Insert(hash, term_id)) {
+        colliding_term_ids_.emplace(terms_[term_id], term_id);
+    }
+}
+
+void InvertedIndex::EraseTermId(int term_id) {
+    const uint64_t hash = HashTerm(terms_[term_id]);
+    const int* found_term_id = term_ids_by_hash_.Find(hash);
+    if (found_term_id != nullptr && *found_term_id == term_id) {
+        term_ids_by_hash_.Erase(hash);
+    }
+    else {
+        colliding_term_ids_.erase(terms_[term_id]);
+    }
+}
+
+std::string_view InvertedIndex::GetTerm(int term_id) const {
+    if (mapped_dictionary_) {
+        if (term_id < 0 || static_cast<size_t>(term_id) >= GetTermCount()) {
+            throw std::out_of_range("There is no term with this term_id");
+        }
+        const Span<uint64_t>& term_offsets = mapped_dictionary_->term_offsets;
+        return { mapped_dictionary_->term_chars.data() + term_offsets[term_id],
+            static_cast<size_t>(term_offsets[term_id + 1] - term_offsets[term_id]) };
+    }
+    return terms_.at(term_id);
+}
+
+size_t InvertedIndex::GetTermCount() const {
+    if (mapped_dictionary_) {
+        return mapped_dictionary_->document_freqs.size();
+    }
+    return terms_.size();
+}
+
+/*! \fn InvertedIndex::GetDocumentFreq
+ *  \b   \b :   \n
+ *  \b   \b :         \n
+ *  \b  \b :  \n
+ *  \param[in] term_id   \n
+ *  \return   \n
+ */
+int InvertedIndex::GetDocumentFreq(int term_id) const {
+    if (mapped_dictionary_) {
+        if (term_id < 0 || static_cast<size_t>(term_id) >= GetTermCount()) {
+            throw std::out_of_range("There is no term with this term_id");
+        }
+        return mapped_dictionary_->document_freqs[term_id];
+    }
+    return document_freqs_.at(term_id);
+}
+
+/*! \fn InvertedIndex::GetTotalDocumentLength
+ *  \b   \b :   \n
+ *  \b   \b :        .
+ *                            \n
+ *  \b  \b :  \n
+ *  \return   \n
+ */
+uint64_t InvertedIndex::GetTotalDocumentLength() const {
+    return total_document_length_;
+}
+
+/*! \fn InvertedIndex::GetSegmentCount
+ *  \b   \b :   \n
+ *  \b   \b :  .    
+ *                         ,   -  \n
+ *  \b  \b :  \n
+ *  \return   \n
+ */
+size_t InvertedIndex::GetSegmentCount() const {
+    return segments_.size() + 1;
+}
+
+int InvertedIndex::GetSegmentFirstDocumentId(size_t segment) const {
+    return segment < segments_.size() ? segments_[segment]->first_document_id : mutable_first_document_id_;
+}
+
+int InvertedIndex::GetSegmentEndDocumentId(size_t segment) const {
+    return segment < segments_.size() ? segments_[segment]->end_document_id : end_document_id_;
+}
+
+/*! \fn InvertedIndex::GetPostings
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :      .  
+ *                         \n
+ *  \param[in] segment   \n
+ *  \param[in] term_id   \n
+ *  \return  , ,      \n
+ */
+InvertedIndex::Postings InvertedIndex::GetPostings(size_t segment, int term_id) const {
+    if (segment < segments_.size()) {
+        return segments_[segment]->GetPostings(term_id);
+    }
+    if (static_cast<size_t>(term_id) >= mutable_postings_.size() || !mutable_postings_[term_id]) {
+        return {};
+    }
+
+    const PostingList& posting_list = *mutable_postings_[term_id];
+    Postings postings;
+    postings.blocks = posting_list.blocks.data();
+    postings.block_count = posting_list.blocks.size();
+    postings.size = posting_list.document_ids.size();
+    postings.max_term_freq = posting_list.max_term_freq;
+    postings.document_ids = posting_list.document_ids.data();
+    postings.counts = posting_list.counts.data();
+    postings.inverse_document_lengths = mutable_inverse_document_lengths_.data();
+    postings.first_document_id = mutable_first_document_id_;
+    return postings;
+}
+
+/*! \fn InvertedIndex::HasPosting
+ *  \b   \b :   \n
+ *  \b   \b :     .     
+ *                       ,   ,    \n
+ *  \b  \b :  \n
+ *  \param[in] term_id   \n
+ *  \param[in] document_id    \n
+ *  \return true,      \n
+ */
+bool InvertedIndex::HasPosting(int term_id, int document_id) const {
+    const PostingIterator iterator(GetPostings(FindSegment(document_id), term_id), document_id, document_id + 1);
+    return !iterator.IsEnd();
+}
+
+bool InvertedIndex::IsDeleted(int document_id) const {
+    return static_cast<size_t>(document_id) < deleted_documents_.size() && deleted_documents_[document_id];
+}
+
+/*! \fn InvertedIndex::AddDocument
+ *  \b   \b :   \n
+ *  \b   \b :     .    
+ *                       ,    .   
+ *                        MAX_MUTABLE_POSTING_COUNT ,  
+ *                        \n
+ *  \b  \b :       \n
+ *  \param[in] document_id    \n
+ *  \param[in] term_ids      ,   \n
+ *  \return  \n
+ */
+void InvertedIndex::AddDocument(int document_id, const std::vector<int>& term_ids) {
+    if (document_id < end_document_id_) {
+        throw std::invalid_argument("Documents must follow the indexed ones");
+    }
+    Detach();
+    if (mutable_posting_count_ >= MAX_MUTABLE_POSTING_COUNT) {
+        Flush();
+    }
+
+    const double inverse_document_length = 1.0 / term_ids.size();
+    mutable_inverse_document_lengths_.resize(document_id - mutable_first_document_id_);
+    mutable_inverse_document_lengths_.push_back(term_ids.empty() ? 0.0 : inverse_document_length);
+    end_document_id_ = document_id + 1;
+    total_document_length_ += term_ids.size();
+
+    std::vector<int> sorted_term_ids = term_ids;
+    std::sort(sorted_term_ids.begin(), sorted_term_ids.end());
+    for (auto first = sorted_term_ids.begin(); first != sorted_term_ids.end();) {
+        const auto last = std::upper_bound(first, sorted_term_ids.end(), *first);
+        const int count = static_cast<int>(last - first);
+        const double term_freq = ComputeTermFreq(count, inverse_document_length);
+
+        while (mutable_postings_.size() <= static_cast<size_t>(*first)) {
+            mutable_postings_.push_back(nullptr);
+        }
+        std::shared_ptr<PostingList>& shared_postings = mutable_postings_.GetMutable(*first);
+        if (!shared_postings) {
+            shared_postings = std::make_shared<PostingList>();
+        }
+        PostingList& postings = MakeChunkUnique(shared_postings);
+        postings.document_ids.push_back(document_id);
+        postings.counts.push_back(count);
+        postings.max_term_freq = std::max(postings.max_term_freq, term_freq);
+        if (postings.document_ids.size() % BLOCK_SIZE == 1) {
+            postings.blocks.push_back({ document_id, document_id, term_freq, 0 });
+        }
+        else {
+            postings.blocks.back().last_document_id = document_id;
+            postings.blocks.back().max_term_freq = std::max(postings.blocks.back().max_term_freq, term_freq);
+        }
+        ++document_freqs_.GetMutable(*first);
+        ++mutable_posting_count_;
+        first = last;
+    }
+}
+
+/*! \fn InvertedIndex::AddSegment
+ *  \b   \b :   \n
+ *  \b   \b :      . 
+ *                             , 
+ *                       .     \n
+ *  \b  \b :       ,
+ *                          \n
+ *  \param[in] first_document_id      \n
+ *  \param[in] document_term_counts    -      \n
+ *  \return  \n
+ */
+void InvertedIndex::AddSegment(int first_document_id,
+                               const std::vector<std::vector<std::pair<int, int>>>& document_term_counts)
+{
+    if (first_document_id < end_document_id_) {
+        throw std::invalid_argument("Documents must follow the indexed ones");
+    }
+    if (document_term_counts.empty()) {
+        return;
+    }
+    Detach();
+    Flush();
+
+    /* term_positions[term_id] -   ,   -   */
+    std::vector<size_t> term_positions(terms_.size() + 1);
+    std::vector<double> inverse_document_lengths(document_term_counts.size());
+    for (size_t i = 0; i < document_term_counts.size(); ++i) {
+        size_t document_length = 0;
+        for (const auto& [term_id, count] : document_term_counts[i]) {
+            ++term_positions[term_id + 1];
+            document_length += count;
+        }
+        inverse_document_lengths[i] = document_length == 0 ? 0.0 : 1.0 / document_length;
+        total_document_length_ += document_length;
+    }
+    std::partial_sum(term_positions.begin(), term_positions.end(), term_positions.begin());
+
+    const size_t posting_count = term_positions.back();
+    std::vector<int> document_ids(posting_count);
+    std::vector<int> counts(posting_count);
+    for (size_t i = 0; i < document_term_counts.size(); ++i) {
+        for (const auto& [term_id, count] : document_term_counts[i]) {
+            const size_t position = term_positions[term_id]++;
+            document_ids[position] = first_document_id + static_cast<int>(i);
+            counts[position] = count;
+        }
+    }
+
+    const int end_document_id = first_document_id + static_cast<int>(document_term_counts.size());
+    SegmentBuilder builder(first_document_id, end_document_id, std::move(inverse_document_lengths));
+    size_t position = 0;
+    for (size_t term_id = 0; term_id < terms_.size(); ++term_id) {
+        if (position == term_positions[term_id]) {
+            continue;
+        }
+        document_freqs_.GetMutable(term_id) += static_cast<int>(term_positions[term_id] - position);
+        builder.AddTerm(static_cast<int>(term_id));
+        for (; position < term_positions[term_id]; ++position) {
+            builder.AddPosting(document_ids[position], counts[position]);
+        }
+        builder.FinishTerm();
+    }
+
+    segments_.push_back(builder.Build());
+    mutable_first_document_id_ = end_document_id_ = end_document_id;
+    ScheduleMerge();
+}
+
+/*! \fn InvertedIndex::RemoveDocument
+ *  \b   \b :   \n
+ *  \b   \b :  .   ,  
+ *                         ,       
+ *                         \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \param[in] term_ids     \n
+ *  \return  \n
+ */
+void InvertedIndex::RemoveDocument(int document_id, const std::vector<int>& term_ids) {
+    if (IsDeleted(document_id)) {
+        return;
+    }
+    Detach();
+
+    if (deleted_documents_.size() <= static_cast<size_t>(document_id)) {
+        deleted_documents_.resize(document_id + 1);
+    }
+    deleted_documents_[document_id] = true;
+    total_document_length_ -= ComputeDocumentLength(GetInverseDocumentLength(document_id));
+    for (const int term_id : term_ids) {
+        --document_freqs_.GetMutable(term_id);
+    }
+    unpurged_documents_.push_back(document_id);
+    unpurged_posting_count_ += term_ids.size();
+}
+
+/*! \fn InvertedIndex::NeedsPurge
+ *  \b   \b :   \n
+ *  \b   \b : ,       
+ *                      1 / PURGE_FACTOR  .     ,
+ *                       PURGE_FACTOR    ,   
+ *                         \n
+ *  \b  \b :  \n
+ *  \return true,    PurgeDeleted \n
+ */
+bool InvertedIndex::NeedsPurge() const {
+    size_t posting_count = mutable_posting_count_;
+    for (const auto& segment : segments_) {
+        posting_count += segment->GetPostingCount();
+    }
+    return unpurged_posting_count_ > 0 && unpurged_posting_count_ * PURGE_FACTOR >= posting_count;
+}
+
+/*! \fn InvertedIndex::PreparePurge
+ *  \b   \b :   \n
+ *  \b   \b :   ,     
+ *                          \n
+ *  \b  \b :  \n
+ *  \return     \n
+ */
+std::vector<size_t> InvertedIndex::PreparePurge() {
+    Detach();
+    Flush();
+    WaitForMerges();
+
+    std::sort(unpurged_documents_.begin(), unpurged_documents_.end());
+    std::vector<size_t> result;
+    for (size_t segment = 0; segment < segments_.size(); ++segment) {
+        const auto first = std::lower_bound(unpurged_documents_.begin(), unpurged_documents_.end(),
+            segments_[segment]->first_document_id);
+        if (first != unpurged_documents_.end() && *first < segments_[segment]->end_document_id) {
+            result.push_back(segment);
+        }
+    }
+    return result;
+}
+
+/*! \fn InvertedIndex::InstallPurge
+ *  \b   \b :   \n
+ *  \b   \b :          .
+ *                              ,  
+ *                           \n
+ *  \b  \b :  \n
+ *  \param[in] segments    \n
+ *  \param[in,out] purged_segments  ,    \n
+ *  \return  \n
+ */
+void InvertedIndex::InstallPurge(const std::vector<size_t>& segments,
+                                 std::vector<std::shared_ptr<const Segment>>& purged_segments)
+{
+    for (size_t i = 0; i < segments.size(); ++i) {
+        segments_[segments[i]] = std::move(purged_segments[i]);
+    }
+    unpurged_documents_.clear();
+    unpurged_posting_count_ = 0;
+
+    for (size_t term_id = 0; term_id < terms_.size(); ++term_id) {
+        if (document_freqs_[term_id] > 0 || terms_[term_id].empty()) {
+            continue;
+        }
+        EraseTermId(static_cast<int>(term_id));
+        term_chars_.Release(terms_[term_id]);
+        terms_.GetMutable(term_id) = {};
+        free_term_ids_.push_back(static_cast<int>(term_id));
+    }
+}
+
+/*! \fn InvertedIndex::Flush
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                         ,   MERGE_FACTOR  
+ *                      .       \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void InvertedIndex::Flush() {
+    InstallMerge(false);
+    if (mutable_first_document_id_ == end_document_id_) {
+        return;
+    }
+
+    SegmentBuilder builder(mutable_first_document_id_, end_document_id_,
+        std::move(mutable_inverse_document_lengths_));
+    for (size_t term_id = 0; term_id < mutable_postings_.size(); ++term_id) {
+        if (!mutable_postings_[term_id]) {
+            continue;
+        }
+        const PostingList& postings = *mutable_postings_[term_id];
+        builder.AddTerm(static_cast<int>(term_id));
+        for (size_t i = 0; i < postings.document_ids.size(); ++i) {
+            if (!IsDeleted(postings.document_ids[i])) {
+                builder.AddPosting(postings.document_ids[i], postings.counts[i]);
+            }
+        }
+        builder.FinishTerm();
+    }
+
+    segments_.push_back(builder.Build());
+    mutable_postings_.clear();
+    mutable_inverse_document_lengths_.clear();
+    mutable_posting_count_ = 0;
+    mutable_first_document_id_ = end_document_id_;
+    ScheduleMerge();
+}
+
+/*! \fn InvertedIndex::WaitForMerges
+ *  \b   \b :   \n
+ *  \b   \b :     ,   
+ *                          \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void InvertedIndex::WaitForMerges() {
+    while (merge_.result.valid()) {
+        InstallMerge(true);
+    }
+}
+
+/*! \fn InvertedIndex::Save
+ *  \b   \b :   \n
+ *  \b   \b :        .  
+ *                        ,    ,
+ *                           \n
+ *  \b  \b :       \n
+ *  \param[in,out] writer   \n
+ *  \param[in] new_document_ids    , -1    \n
+ *  \param[in] document_count      \n
+ *  \return  \n
+ */
+void InvertedIndex::Save(IndexFileWriter& writer,
+                         const std::vector<int>& new_document_ids,
+                         int document_count) const
+{
+    const size_t term_count = GetTermCount();
+    std::vector<char> term_chars;
+    std::vector<uint64_t> term_offsets(1, 0);
+    std::vector<int> sorted_term_ids(term_count);
+    std::vector<int> document_freqs(term_count);
+    for (size_t term_id = 0; term_id < term_count; ++term_id) {
+        const std::string_view term = GetTerm(static_cast<int>(term_id));
+        term_chars.insert(term_chars.end(), term.begin(), term.end());
+        term_offsets.push_back(term_chars.size());
+        document_freqs[term_id] = GetDocumentFreq(static_cast<int>(term_id));
+    }
+    std::iota(sorted_term_ids.begin(), sorted_term_ids.end(), 0);
+    std::sort(sorted_term_ids.begin(), sorted_term_ids.end(), [this](int lhs, int rhs) {
+        return GetTerm(lhs) < GetTerm(rhs);
+    });
+
+    std::vector<double> inverse_document_lengths(document_count);
+    for (size_t document_id = 0; document_id < new_document_ids.size(); ++document_id) {
+        if (new_document_ids[document_id] >= 0) {
+            inverse_document_lengths.at(new_document_ids[document_id]) =
+                GetInverseDocumentLength(static_cast<int>(document_id));
+        }
+    }
+
+    SegmentBuilder builder(0, document_count, std::move(inverse_document_lengths));
+    for (size_t term_id = 0; term_id < term_count; ++term_id) {
+        builder.AddTerm(static_cast<int>(term_id));
+        for (size_t segment = 0; segment < GetSegmentCount(); ++segment) {
+            PostingIterator iterator(GetPostings(segment, static_cast<int>(term_id)),
+                0, std::numeric_limits<int>::max());
+            for (; !iterator.IsEnd(); iterator.Next()) {
+                const int document_id = new_document_ids.at(iterator.GetDocumentId());
+                if (document_id >= 0) {
+                    builder.AddPosting(document_id, iterator.GetCount());
+                }
+            }
+        }
+        builder.FinishTerm();
+    }
+    const auto segment = builder.Build();
+
+    writer.AddSection(IndexSection::TERM_CHARS, Span<char>(term_chars));
+    writer.AddSection(IndexSection::TERM_OFFSETS, Span<uint64_t>(term_offsets));
+    writer.AddSection(IndexSection::SORTED_TERM_IDS, Span<int>(sorted_term_ids));
+    writer.AddSection(IndexSection::DOCUMENT_FREQS, Span<int>(document_freqs));
+    writer.AddSection(IndexSection::SEGMENT_TERM_IDS, segment->term_ids);
+    writer.AddSection(IndexSection::SEGMENT_OFFSETS, segment->offsets);
+    writer.AddSection(IndexSection::SEGMENT_BLOCK_OFFSETS, segment->block_offsets);
+    writer.AddSection(IndexSection::SEGMENT_MAX_TERM_FREQS, segment->max_term_freqs);
+    writer.AddSection(IndexSection::SEGMENT_BLOCKS, segment->blocks);
+    writer.AddSection(IndexSection::SEGMENT_DATA, segment->data);
+    writer.AddSection(IndexSection::SEGMENT_INVERSE_DOCUMENT_LENGTHS, segment->inverse_document_lengths);
+    writer.AddSection(IndexSection::TOTAL_DOCUMENT_LENGTH, Span<uint64_t>(&total_document_length_, 1));
+}
+
+/*! \fn InvertedIndex::Map
+ *  \b   \b :   \n
+ *  \b   \b :          .
+ *                          ,     
+ *                          .   :  
+ *                            \n
+ *  \b  \b :    .      .
+ *                              \n
+ *  \param[in] reader   \n
+ *  \param[in] document_count     \n
+ *  \return  \n
+ */
+void InvertedIndex::Map(const IndexFileReader& reader, int document_count) {
+    if (GetTermCount() > 0 || end_document_id_ > 0) {
+        throw std::logic_error("Index is not empty");
+    }
+
+    MappedDictionary dictionary;
+    dictionary.term_chars = reader.GetSection<char>(IndexSection::TERM_CHARS);
+    dictionary.term_offsets = reader.GetSection<uint64_t>(IndexSection::TERM_OFFSETS);
+    dictionary.sorted_term_ids = reader.GetSection<int>(IndexSection::SORTED_TERM_IDS);
+    dictionary.document_freqs = reader.GetSection<int>(IndexSection::DOCUMENT_FREQS);
+    const size_t term_count = dictionary.document_freqs.size();
+    if (dictionary.term_offsets.size() != term_count + 1 ||
+        !AreValidOffsets(dictionary.term_offsets, dictionary.term_chars.size()) ||
+        dictionary.sorted_term_ids.size() != term_count ||
+        std::any_of(dictionary.sorted_term_ids.begin(), dictionary.sorted_term_ids.end(), [term_count](int term_id) {
+            return term_id < 0 || static_cast<size_t>(term_id) >= term_count;
+        })) {
+        throw std::invalid_argument("Index file dictionary is corrupted");
+    }
+    const Span<uint64_t> total_document_length = reader.GetSection<uint64_t>(IndexSection::TOTAL_DOCUMENT_LENGTH);
+    if (total_document_length.size() != 1) {
+        throw std::invalid_argument("Index file document length is corrupted");
+    }
+
+    auto segment = std::make_shared<Segment>();
+    segment->first_document_id = 0;
+    segment->end_document_id = document_count;
+    segment->term_ids = reader.GetSection<int>(IndexSection::SEGMENT_TERM_IDS);
+    segment->offsets = reader.GetSection<uint64_t>(IndexSection::SEGMENT_OFFSETS);
+    segment->block_offsets = reader.GetSection<uint64_t>(IndexSection::SEGMENT_BLOCK_OFFSETS);
+    segment->max_term_freqs = reader.GetSection<double>(IndexSection::SEGMENT_MAX_TERM_FREQS);
+    segment->blocks = reader.GetSection<PostingBlock>(IndexSection::SEGMENT_BLOCKS);
+    segment->data = reader.GetSection<uint8_t>(IndexSection::SEGMENT_DATA);
+    segment->inverse_document_lengths = reader.GetSection<double>(IndexSection::SEGMENT_INVERSE_DOCUMENT_LENGTHS);
+    segment->storage = reader.GetFile();
+    if (!segment->IsValid(term_count)) {
+        throw std::invalid_argument("Index file segment is corrupted");
+    }
+
+    mapped_dictionary_ = dictionary;
+    term_storage_ = reader.GetFile();
+    total_document_length_ = total_document_length[0];
+    if (document_count > 0) {
+        segments_.push_back(std::move(segment));
+    }
+    mutable_first_document_id_ = end_document_id_ = document_count;
+}
+
+/*! \fn InvertedIndex::Detach
+ *  \b   \b :   \n
+ *  \b   \b :        
+ *                      .   :     \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void InvertedIndex::Detach() {
+    if (!mapped_dictionary_) {
+        return;
+    }
+
+    const size_t term_count = GetTermCount();
+    std::vector<std::pair<uint64_t, int>> term_ids_by_hash;
+    term_ids_by_hash.reserve(term_count);
+    for (size_t term_id = 0; term_id < term_count; ++term_id) {
+        terms_.push_back(GetTerm(static_cast<int>(term_id)));
+        document_freqs_.push_back(mapped_dictionary_->document_freqs[term_id]);
+        /*        */
+        if (terms_.back().empty()) {
+            free_term_ids_.push_back(static_cast<int>(term_id));
+            continue;
+        }
+        term_ids_by_hash.emplace_back(HashTerm(terms_.back()), static_cast<int>(term_id));
+    }
+    std::sort(term_ids_by_hash.begin(), term_ids_by_hash.end());
+    const auto colliding = std::unique(term_ids_by_hash.begin(), term_ids_by_hash.end(),
+        [](const auto& lhs, const auto& rhs) {return lhs.first == rhs.first;});
+    for (auto iterator = colliding; iterator != term_ids_by_hash.end(); ++iterator) {
+        colliding_term_ids_.emplace(terms_[iterator->second], iterator->second);
+    }
+    term_ids_by_hash.erase(colliding, term_ids_by_hash.end());
+    term_ids_by_hash_ = ChunkedMap<uint64_t, int>(term_ids_by_hash);
+    mapped_dictionary_.reset();
+}
+
+/*! \fn InvertedIndex::GetMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :  ,        \n
+ *  \b  \b :     .   ,
+ *                         ,  \n
+ *  \return   \n
+ */
+InvertedIndex::MemoryStats InvertedIndex::GetMemoryStats() const {
+    /*  unordered_map:    ,  -    */
+    static const size_t HASH_NODE_SIZE =
+        sizeof(void*) + sizeof(std::pair<const std::string_view, int>) + sizeof(size_t);
+
+    MemoryStats stats;
+    stats.term_count = GetTermCount() - free_term_ids_.size();
+    stats.segment_count = segments_.size() + (mutable_posting_count_ == 0 ? 0 : 1);
+    if (mapped_dictionary_) {
+        stats.dictionary_bytes = mapped_dictionary_->term_chars.size() +
+            mapped_dictionary_->term_offsets.size() * sizeof(uint64_t) +
+            mapped_dictionary_->sorted_term_ids.size() * sizeof(int) +
+            mapped_dictionary_->document_freqs.size() * sizeof(int);
+    }
+    else {
+        stats.dictionary_bytes = term_ids_by_hash_.GetMemoryBytes() +
+            colliding_term_ids_.bucket_count() * sizeof(void*) +
+            colliding_term_ids_.size() * HASH_NODE_SIZE +
+            terms_.GetMemoryBytes() +
+            document_freqs_.GetMemoryBytes() +
+            term_chars_.GetMemoryStats().reserved_bytes;
+    }
+    stats.posting_bytes = deleted_documents_.capacity() / 8 +
+        segments_.capacity() * sizeof(std::shared_ptr<const Segment>) +
+        mutable_postings_.GetMemoryBytes();
+    for (const auto& segment : segments_) {
+        stats.posting_count += segment->GetPostingCount();
+        stats.posting_bytes += segment->GetMemoryBytes();
+    }
+    stats.posting_bytes += mutable_inverse_document_lengths_.capacity() * sizeof(double);
+    for (size_t term_id = 0; term_id < mutable_postings_.size(); ++term_id) {
+        if (!mutable_postings_[term_id]) {
+            continue;
+        }
+        const PostingList& postings = *mutable_postings_[term_id];
+        stats.posting_count += postings.document_ids.size();
+        stats.posting_bytes += sizeof(PostingList) +
+            postings.document_ids.capacity() * sizeof(int) +
+            postings.counts.capacity() * sizeof(int) +
+            postings.blocks.capacity() * sizeof(PostingBlock);
+    }
+    return stats;
+}
+
+/*! \fn InvertedIndex::EstimateTreeMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :      std::map
+ *                      (std::map<std::string_view, std::map<int, double>>)   \n
+ *  \b  \b :          ,
+ *                           \n
+ *  \param[in] term_count   \n
+ *  \param[in] posting_count   - \n
+ *  \return   \n
+ */
+InvertedIndex::MemoryStats InvertedIndex::EstimateTreeMemoryStats(size_t term_count,
+                                                                  size_t posting_count)
+{
+    static const size_t TREE_NODE_HEADER_SIZE = 4 * sizeof(void*);
+
+    MemoryStats stats;
+    stats.term_count = term_count;
+    stats.posting_count = posting_count;
+    stats.dictionary_bytes = term_count * (TREE_NODE_HEADER_SIZE +
+        sizeof(std::pair<const std::string_view, std::map<int, double>>));
+    stats.posting_bytes = posting_count * (TREE_NODE_HEADER_SIZE +
+        sizeof(std::pair<const int, double>));
+    return stats;
+}
+
+/*! \fn InvertedIndex::FindSegment
+ *  \b   \b :   \n
+ *  \b   \b :  ,     \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \return  ,        \n
+ */
+size_t InvertedIndex::FindSegment(int document_id) const {
+    if (document_id >= mutable_first_document_id_) {
+        return segments_.size();
+    }
+    const auto iterator = std::upper_bound(segments_.begin(), segments_.end(), document_id,
+        [](int id, const std::shared_ptr<const Segment>& segment) {
+            return id < segment->first_document_id;
+        });
+    return iterator == segments_.begin() ? segments_.size() : (iterator - segments_.begin()) - 1;
+}
+
+double InvertedIndex::GetInverseDocumentLength(int document_id) const {
+    const size_t segment = FindSegment(document_id);
+    if (segment == segments_.size()) {
+        const size_t position = document_id - mutable_first_document_id_;
+        return position < mutable_inverse_document_lengths_.size() ? mutable_inverse_document_lengths_[position] : 0.0;
+    }
+    return segments_[segment]->inverse_document_lengths[document_id - segments_[segment]->first_document_id];
+}
+
+/*! \fn InvertedIndex::InstallMerge
+ *  \b   \b :   \n
+ *  \b   \b :       
+ *                          \n
+ *  \b  \b :  \n
+ *  \param[in] wait    \n
+ *  \return  \n
+ */
+void InvertedIndex::InstallMerge(bool wait) {
+    if (!merge_.result.valid()) {
+        return;
+    }
+    if (!wait && merge_.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+
+    std::shared_ptr<const Segment> merged_segment = merge_.result.get();
+    /*     ,        */
+    const auto first = segments_.begin() + merge_.first_segment;
+    const auto last = segments_.erase(first + 1, first + merge_.segments.size());
+    *(last - 1) = std::move(merged_segment);
+    merge_ = PendingMerge{};
+    ScheduleMerge();
+}
+
+/*! \fn InvertedIndex::ScheduleMerge
+ *  \b   \b :   \n
+ *  \b   \b :    MERGE_FACTOR    .
+ *                        -      MERGE_FACTOR
+ *                          MAX_MUTABLE_POSTING_COUNT, 
+ *                        O(MERGE_FACTOR * log(N)) \n
+ *  \b  \b :       \n
+ *  \return  \n
+ */
+void InvertedIndex::ScheduleMerge() {
+    if (merge_.result.valid() || segments_.size() < MERGE_FACTOR) {
+        return;
+    }
+
+    auto get_level = [](const std::shared_ptr<const Segment>& segment) {
+        size_t level = 0;
+        for (size_t size = MAX_MUTABLE_POSTING_COUNT * MERGE_FACTOR;
+            segment->GetPostingCount() >= size; size *= MERGE_FACTOR) {
+            ++level;
+        }
+        return level;
+    };
+
+    /*    ,      */
+    for (size_t first = segments_.size() - MERGE_FACTOR + 1; first-- > 0;) {
+        const auto begin = segments_.begin() + first;
+        const auto end = begin + MERGE_FACTOR;
+        const size_t level = get_level(*begin);
+        if (std::all_of(begin, end, [&](const auto& segment) { return get_level(segment) == level; })) {
+            merge_.first_segment = first;
+            merge_.segments.assign(begin, end);
+            merge_.result = std::async(std::launch::async,
+                [segments = merge_.segments, deleted_documents = deleted_documents_]() {
+                    return MergeSegments(segments, deleted_documents);
+                }).share();
+            return;
+        }
+    }
+}
+
+/*! \fn InvertedIndex::MergeSegments
+ *  \b   \b :   \n
+ *  \b   \b :         
+ *                      .        ,
+ *                         \n
+ *  \b  \b :    ,      \n
+ *  \param[in] segments     \n
+ *  \param[in] deleted_documents       \n
+ *  \return   \n
+ */
+std::shared_ptr<const InvertedIndex::Segment> InvertedIndex::MergeSegments(
+    const std::vector<std::shared_ptr<const Segment>>& segments,
+    const std::vector<bool>& deleted_documents)
+{
+    auto is_deleted = [&deleted_documents](int document_id) {
+        return static_cast<size_t>(document_id) < deleted_documents.size() && deleted_documents[document_id];
+    };
+
+    std::vector<double> inverse_document_lengths;
+    for (const auto& segment : segments) {
+        inverse_document_lengths.insert(inverse_document_lengths.end(),
+            segment->inverse_document_lengths.begin(), segment->inverse_document_lengths.end());
+    }
+    SegmentBuilder builder(segments.front()->first_document_id, segments.back()->end_document_id,
+        std::move(inverse_document_lengths));
+
+    std::vector<size_t> term_positions(segments.size());
+    while (true) {
+        int term_id = std::numeric_limits<int>::max();
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (term_positions[i] < segments[i]->term_ids.size()) {
+                term_id = std::min(term_id, segments[i]->term_ids[term_positions[i]]);
+            }
+        }
+        if (term_id == std::numeric_limits<int>::max()) {
+            break;
+        }
+
+        builder.AddTerm(term_id);
+        for (size_t i = 0; i < segments.size(); ++i) {
+            size_t& term_position = term_positions[i];
+            if (term_position == segments[i]->term_ids.size() || segments[i]->term_ids[term_position] != term_id) {
+                continue;
+            }
+            PostingIterator iterator(segments[i]->GetTermPostings(term_position++),
+                0, std::numeric_limits<int>::max());
+            for (; !iterator.IsEnd(); iterator.Next()) {
+                if (!is_deleted(iterator.GetDocumentId())) {
+                    builder.AddPosting(iterator.GetDocumentId(), iterator.GetCount());
+                }
+            }
+        }
+        builder.FinishTerm();
+    }
+    return builder.Build();
+}
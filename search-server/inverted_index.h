@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "chunked_map.h"
+#include "chunked_vector.h"
+#include "index_file.h"
+#include "text_arena.h"
+
+class InvertedIndex {
+public:
+    static constexpr int NO_TERM = -1;
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t MAX_MUTABLE_POSTING_COUNT = 1 << 14;
+    static constexpr size_t MERGE_FACTOR = 4;
+    static constexpr size_t PURGE_FACTOR = 4;
+
+    /*   BLOCK_SIZE   .    :
+              */
+    struct PostingBlock {
+        int first_document_id;
+        int last_document_id;
+        double max_term_freq;
+        uint64_t data_offset; /*!<        */
+    };
+
+    /*      .   .  
+         ,       document_ids  counts */
+    struct Postings {
+        const PostingBlock* blocks = nullptr;
+        size_t block_count = 0;
+        size_t size = 0;                                  /*!<   */
+        double max_term_freq = 0.0;                       /*!<      */
+        const uint8_t* data = nullptr;                    /*!<   */
+        const int* document_ids = nullptr;                /*!<    */
+        const int* counts = nullptr;                      /*!<    */
+        const double* inverse_document_lengths = nullptr; /*!<     */
+        int first_document_id = 0;                        /*!<  inverse_document_lengths[0] */
+    };
+
+    class PostingIterator;
+
+    struct MemoryStats {
+        size_t term_count = 0;
+        size_t posting_count = 0;
+        size_t segment_count = 0;
+        size_t dictionary_bytes = 0;
+        size_t posting_bytes = 0;
+
+        double GetBytesPerPosting() const;
+    };
+
+    int AddTerm(std::string_view word);
+    int FindTerm(std::string_view word) const;
+    std::string_view GetTerm(int term_id) const;
+    size_t GetTermCount() const;
+    int GetDocumentFreq(int term_id) const;
+    uint64_t GetTotalDocumentLength() const;
+
+    size_t GetSegmentCount() const;
+    int GetSegmentFirstDocumentId(size_t segment) const;
+    int GetSegmentEndDocumentId(size_t segment) const;
+    Postings GetPostings(size_t segment, int term_id) const;
+    bool HasPosting(int term_id, int document_id) const;
+    bool IsDeleted(int document_id) const;
+
+    void AddDocument(int document_id, const std::vector<int>& term_ids);
+    void AddSegment(int first_document_id,
+                    const std::vector<std::vector<std::pair<int, int>>>& document_term_counts);
+    void RemoveDocument(int document_id, const std::vector<int>& term_ids);
+    bool NeedsPurge() const;
+    template <typename ParallelFor>
+    void PurgeDeleted(ParallelFor parallel_for);
+    void Flush();
+    void WaitForMerges();
+
+    void Save(IndexFileWriter& writer, const std::vector<int>& new_document_ids, int document_count) const;
+    void Map(const IndexFileReader& reader, int document_count);
+
+    MemoryStats GetMemoryStats() const;
+    static MemoryStats EstimateTreeMemoryStats(size_t term_count, size_t posting_count);
+
+private:
+    /*  :        .
+               */
+    struct Segment {
+        int first_document_id = 0;
+        int end_document_id = 0;
+        Span<int> term_ids;                   /*!<      */
+        Span<uint64_t> offsets;               /*!<       */
+        Span<uint64_t> block_offsets;         /*!<     blocks */
+        Span<double> max_term_freqs;
+        Span<PostingBlock> blocks;
+        Span<uint8_t> data;
+        Span<double> inverse_document_lengths; /*!<     first_document_id */
+        std::shared_ptr<const void> storage;  /*!<   */
+
+        Postings GetPostings(int term_id) const;
+        Postings GetTermPostings(size_t term_index) const;
+        bool IsValid(size_t term_count) const;
+        size_t GetPostingCount() const;
+        size_t GetMemoryBytes() const;
+    };
+
+    /*  :       .
+          :     
+                */
+    struct SegmentBuilder {
+        int first_document_id = 0;
+        int end_document_id = 0;
+        std::vector<double> inverse_document_lengths;
+        std::vector<int> term_ids;
+        std::vector<uint64_t> offsets;
+        std::vector<uint64_t> block_offsets;
+        std::vector<double> max_term_freqs;
+        std::vector<PostingBlock> blocks;
+        std::vector<uint8_t> data;
+        uint64_t posting_count = 0;
+        std::vector<int> block_document_ids; /*!<      */
+        std::vector<int> block_counts;
+
+        SegmentBuilder(int first_document_id, int end_document_id,
+                       std::vector<double> inverse_document_lengths);
+
+        void AddTerm(int term_id);
+        void AddPosting(int document_id, int count);
+        void FinishTerm();
+        std::shared_ptr<const Segment> Build();
+
+    private:
+        void PackBlock();
+    };
+
+    /*      .     
+           ,   ChunkedVector */
+    struct PostingList {
+        std::vector<int> document_ids;
+        std::vector<int> counts;
+        std::vector<PostingBlock> blocks;
+        double max_term_freq = 0.0;
+    };
+
+    /*      */
+    struct MappedDictionary {
+        Span<char> term_chars;
+        Span<uint64_t> term_offsets;     /*!<    term_chars,      */
+        Span<int> sorted_term_ids;       /*!<       */
+        Span<int> document_freqs;
+    };
+
+    struct PendingMerge {
+        size_t first_segment = 0;
+        std::vector<std::shared_ptr<const Segment>> segments;
+        std::shared_future<std::shared_ptr<const Segment>> result;
+    };
+
+    /*!        ,    term_ids_by_hash_,
+        terms_  document_freqs_.    ,     term_storage_ */
+    std::optional<MappedDictionary> mapped_dictionary_;
+    std::shared_ptr<const void> term_storage_;
+    TextArena term_chars_; /*!< ,   ,     */
+    /*!      ,     .
+             terms_,        colliding_term_ids_ */
+    ChunkedMap<uint64_t, int> term_ids_by_hash_;
+    std::unordered_map<std::string_view, int> colliding_term_ids_;
+    ChunkedVector<std::string_view> terms_;
+    ChunkedVector<int> document_freqs_;     /*!<      */
+    std::vector<bool> deleted_documents_;   /*!<  ,     */
+    std::vector<int> unpurged_documents_;   /*!<     */
+    size_t unpurged_posting_count_ = 0;     /*!<  ,  :     */
+    std::vector<int> free_term_ids_;        /*!<    ,   */
+
+    std::vector<std::shared_ptr<const Segment>> segments_; /*!<      */
+    ChunkedVector<std::shared_ptr<PostingList>> mutable_postings_; /*!<   , nullptr -   */
+    std::vector<double> mutable_inverse_document_lengths_; /*!<  mutable_first_document_id_ */
+    int mutable_first_document_id_ = 0;
+    int end_document_id_ = 0;
+    uint64_t total_document_length_ = 0;  /*!<        */
+    size_t mutable_posting_count_ = 0;
+    PendingMerge merge_;
+
+    void Detach();
+    static uint64_t HashTerm(std::string_view word);
+    int FindAddedTerm(std::string_view word, uint64_t hash) const;
+    void InsertTermId(int term_id, uint64_t hash);
+    void EraseTermId(int term_id);
+    size_t FindSegment(int document_id) const;
+    double GetInverseDocumentLength(int document_id) const;
+    void InstallMerge(bool wait);
+    std::vector<size_t> PreparePurge();
+    void InstallPurge(const std::vector<size_t>& segments,
+                      std::vector<std::shared_ptr<const Segment>>& purged_segments);
+    void ScheduleMerge();
+    static std::shared_ptr<const Segment> MergeSegments(
+        const std::vector<std::shared_ptr<const Segment>>& segments,
+        const std::vector<bool>& deleted_documents);
+};
+
+/*! \fn InvertedIndex::PurgeDeleted
+ *  \b   \b :   \n
+ *  \b   \b :       . 
+ *                       ,   ,  
+ *                            .
+ *                      ,     ,    \n
+ *  \b  \b :       \n
+ *  \param[in] parallel_for ,  f(i)   i  [0, count): parallel_for(count, f) \n
+ *  \return  \n
+ */
+template <typename ParallelFor>
+void InvertedIndex::PurgeDeleted(ParallelFor parallel_for) {
+    const std::vector<size_t> segments = PreparePurge();
+    std::vector<std::shared_ptr<const Segment>> purged_segments(segments.size());
+    parallel_for(segments.size(), [this, &segments, &purged_segments](size_t i) {
+        purged_segments[i] = MergeSegments({ segments_[segments[i]] }, deleted_documents_);
+    });
+    InstallPurge(segments, purged_segments);
+}
+
+/*! \fn ComputeTermFreq
+ *  \b   \b :   \n
+ *  \b   \b :     .   
+ *                        ,   ,   
+ *                        ,     \n
+ *  \b  \b :  \n
+ *  \param[in] count    \n
+ *  \param[in] inverse_document_length    \n
+ *  \return   \n
+ */
+inline double ComputeTermFreq(int count, double inverse_document_length) {
+    double term_freq = inverse_document_length;
+    for (int i = 1; i < count; ++i) {
+        term_freq += inverse_document_length;
+    }
+    return term_freq;
+}
+
+/*        .  
+   ,      SkipTo   */
+class InvertedIndex::PostingIterator {
+public:
+    PostingIterator(const Postings& postings, int first_document_id, int last_document_id);
+
+    bool IsEnd() const {
+        return block_ == postings_.block_count;
+    }
+
+    int GetDocumentId() const {
+        return document_ids_[position_];
+    }
+
+    int GetCount() const {
+        return counts_[position_];
+    }
+
+    double GetInverseDocumentLength() const {
+        return postings_.inverse_document_lengths[document_ids_[position_] - postings_.first_document_id];
+    }
+
+    double GetTermFreq() const {
+        return ComputeTermFreq(counts_[position_], GetInverseDocumentLength());
+    }
+
+    int GetBlockLastDocumentId() const {
+        return postings_.blocks[block_].last_document_id;
+    }
+
+    double GetBlockMaxTermFreq() const {
+        return postings_.blocks[block_].max_term_freq;
+    }
+
+    void Next() {
+        if (++position_ == block_size_) {
+            LoadBlock(block_ + 1);
+        }
+        else if (document_ids_[position_] >= last_document_id_) {
+            block_ = postings_.block_count;
+        }
+    }
+
+    void SkipTo(int document_id);
+
+private:
+    Postings postings_;
+    int last_document_id_;
+    size_t block_ = 0;
+    size_t block_size_ = 0;
+    size_t position_ = 0;
+    int document_ids_[BLOCK_SIZE];
+    int counts_[BLOCK_SIZE];
+
+    void LoadBlock(size_t block);
+};
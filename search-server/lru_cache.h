@@ -0,0 +1,96 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/*   ,     .
+     */
+template <typename Key, typename Value>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity);
+
+    const Value* Find(const Key& key);
+    bool Put(const Key& key, Value value);
+    void Clear();
+    size_t GetSize() const;
+    size_t GetCapacity() const;
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    size_t capacity_;
+    std::list<Entry> entries_; /*!<       */
+    std::unordered_map<Key, typename std::list<Entry>::iterator> positions_;
+};
+
+template <typename Key, typename Value>
+LruCache<Key, Value>::LruCache(size_t capacity)
+    : capacity_(capacity)
+{
+}
+
+/*! \fn LruCache::Find
+ *  \b   \b :   \n
+ *  \b   \b :  ,      \n
+ *  \b  \b :       \n
+ *  \param[in] key  \n
+ *  \return     nullptr,    \n
+ */
+template <typename Key, typename Value>
+const Value* LruCache<Key, Value>::Find(const Key& key) {
+    const auto iterator = positions_.find(key);
+    if (iterator == positions_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, iterator->second);
+    return &iterator->second->second;
+}
+
+/*! \fn LruCache::Put
+ *  \b   \b :   \n
+ *  \b   \b :    .   
+ *                          \n
+ *  \b  \b :       \n
+ *  \param[in] key  \n
+ *  \param[in] value  \n
+ *  \return true,      \n
+ */
+template <typename Key, typename Value>
+bool LruCache<Key, Value>::Put(const Key& key, Value value) {
+    if (capacity_ == 0) {
+        return false;
+    }
+    const auto iterator = positions_.find(key);
+    if (iterator != positions_.end()) {
+        iterator->second->second = std::move(value);
+        entries_.splice(entries_.begin(), entries_, iterator->second);
+        return false;
+    }
+    bool is_evicted = false;
+    if (entries_.size() == capacity_) {
+        positions_.erase(entries_.back().first);
+        entries_.pop_back();
+        is_evicted = true;
+    }
+    entries_.emplace_front(key, std::move(value));
+    positions_.emplace(key, entries_.begin());
+    return is_evicted;
+}
+
+template <typename Key, typename Value>
+void LruCache<Key, Value>::Clear() {
+    positions_.clear();
+    entries_.clear();
+}
+
+template <typename Key, typename Value>
+size_t LruCache<Key, Value>::GetSize() const {
+    return entries_.size();
+}
+
+template <typename Key, typename Value>
+size_t LruCache<Key, Value>::GetCapacity() const {
+    return capacity_;
+}
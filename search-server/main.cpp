@@ -1,6 +1,8 @@
 #include "search_server.h"
+#include "benchmark_functions.h"
 #include "log_duration.h"
 #include "process_queries.h" //     
+#include "test_example_functions.h"
 #include <execution>
 #include <iostream>
 #include <random>
@@ -64,9 +66,22 @@ void Test(string_view mark, const SearchServer& search_server, const vector<stri
     cout << total_relevance << endl;
 }
 
+void PrintIndexMemoryStats(const SearchServer& search_server) {
+    const auto stats = search_server.GetIndexMemoryStats();
+    const auto tree_stats = InvertedIndex::EstimateTreeMemoryStats(stats.term_count, stats.posting_count);
+    cout << "index: "s << stats.term_count << " terms, "s << stats.posting_count << " postings in "s
+         << stats.segment_count << " segments, "s << stats.GetBytesPerPosting() << " bytes/posting (nested std::map: "s
+         << tree_stats.GetBytesPerPosting() << " bytes/posting)"s << endl;
+}
+
 #define TEST(policy) Test(#policy, search_server, queries, execution::policy)
 
-int main() {
+int main(int argc, char* argv[]) {
+    const string mode = argc > 1 ? argv[1] : ""s;
+    if (mode == "--test"s) {
+        TestSearchServer();
+        return 0;
+    }
     mt19937 generator;
     const vector<string> dictionary = GenerateDictionary(generator, 1000, 10);
     const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
@@ -74,8 +89,12 @@ int main() {
     for (size_t i = 0; i < documents.size(); ++i) {
         search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
     }
+    PrintIndexMemoryStats(search_server);
     const auto queries = GenerateQueries(generator, dictionary, 100, 70);
     //TEST(seq);
     TEST(par);
+    if (mode == "--benchmark"s) {
+        RunBenchmarks();
+    }
     return 0;
 }
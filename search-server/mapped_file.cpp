@@ -0,0 +1,97 @@
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+/*! \fn MappedFile::Open
+ *  \b   \b :   \n
+ *  \b   \b :       .  
+ *                            \n
+ *  \b  \b :    ,    \n
+ *  \param[in] path    \n
+ *  \return   \n
+ */
+std::shared_ptr<const MappedFile> MappedFile::Open(const std::string& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef _WIN32
+    file->file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file->file_ == INVALID_HANDLE_VALUE) {
+        file->file_ = nullptr;
+        throw std::runtime_error("Cannot open file " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file->file_, &size)) {
+        throw std::runtime_error("Cannot get size of file " + path);
+    }
+    file->size_ = static_cast<size_t>(size.QuadPart);
+    if (file->size_ > 0) {
+        file->mapping_ = CreateFileMappingA(file->file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (file->mapping_ == nullptr) {
+            throw std::runtime_error("Cannot map file " + path);
+        }
+        file->data_ = static_cast<const char*>(MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (file->data_ == nullptr) {
+            throw std::runtime_error("Cannot map file " + path);
+        }
+    }
+#else
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Cannot open file " + path);
+    }
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) != 0) {
+        close(descriptor);
+        throw std::runtime_error("Cannot get size of file " + path);
+    }
+    file->size_ = static_cast<size_t>(file_stat.st_size);
+    if (file->size_ > 0) {
+        void* data = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error("Cannot map file " + path);
+        }
+        file->data_ = static_cast<const char*>(data);
+    }
+    /*       */
+    close(descriptor);
+#endif
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != nullptr) {
+        CloseHandle(file_);
+    }
+#else
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+const char* MappedFile::GetData() const {
+    return data_;
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/* ,       */
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> Open(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;    /*!< HANDLE  */
+    void* mapping_ = nullptr; /*!< HANDLE  */
+#endif
+
+    MappedFile() = default;
+};
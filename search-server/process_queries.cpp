@@ -1,22 +1,39 @@
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <execution>
+#include <mutex>
+#include <utility>
 
 #include "process_queries.h"
 
 /*! \fn ProcessQueries
  *  \b   \b :   \n
- *  \b   \b :        \n
+ *  \b   \b :       .
+ *                          ,     \n
  *  \b  \b :  \n
  *  \param[in] search_server   \n
  *  \param[in] queries  \n
+ *  \param[in] strategy   ,      \n
  *  \return ,    \n
  */
 std::vector<std::vector<Document>> ProcessQueries(
     const SearchServer& search_server,
-    const std::vector<std::string>& queries)
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy)
 {
+    if (strategy == QueryBatchStrategy::SHARED_POSTINGS) {
+        return search_server.FindTopDocumentsBatch(queries);
+    }
+
     std::vector<std::vector<Document>> result(queries.size());
 
+    if (const std::shared_ptr<ThreadPool> thread_pool = search_server.GetThreadPool()) {
+        thread_pool->ParallelFor(queries.size(), [&search_server, &queries, &result](size_t i) {
+            result[i] = search_server.FindTopDocuments(queries[i]);
+        });
+        return result;
+    }
     std::transform(std::execution::par,
         queries.begin(), queries.end(),
         result.begin(),
@@ -24,21 +41,42 @@ std::vector<std::vector<Document>> ProcessQueries(
     return result;
 }
 
+/*! \fn ProcessQueries
+ *  \b   \b :   \n
+ *  \b   \b :       , ,
+ *                         ,     \n
+ *  \b  \b :  \n
+ *  \param[in] search_server      \n
+ *  \param[in] queries  \n
+ *  \param[in] strategy    \n
+ *  \return ,    \n
+ */
+std::vector<std::vector<Document>> ProcessQueries(
+    const ConcurrentSearchServer& search_server,
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy)
+{
+    const ConcurrentSearchServer::Snapshot snapshot = search_server.GetSnapshot();
+    return ProcessQueries(*snapshot, queries, strategy);
+}
+
 /*! \fn ProcessQueriesJoined
  *  \b   \b :   \n
  *  \b   \b :        \n
  *  \b  \b :  \n
  *  \param[in] search_server   \n
  *  \param[in] queries  \n
+ *  \param[in] strategy    \n
  *  \return ,       \n
  */
 std::list<Document> ProcessQueriesJoined(
     const SearchServer& search_server,
-    const std::vector<std::string>& queries)
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy)
 {
     std::list<Document> result;
 
-    std::vector<std::vector<Document>> process_queries = ProcessQueries(search_server, queries);
+    std::vector<std::vector<Document>> process_queries = ProcessQueries(search_server, queries, strategy);
     for (const auto& documents : process_queries) {
         for (const auto& document : documents) {
             result.push_back(document);
@@ -46,3 +84,221 @@ std::list<Document> ProcessQueriesJoined(
     }
     return result;
 }
+
+/*     window .  i   i % window
+     ,       i - window */
+struct JoinedDocumentStream::State {
+    struct Slot {
+        bool is_ready = false;
+        std::vector<Document> documents;
+        std::exception_ptr error;
+    };
+
+    const SearchServer& search_server;
+    const std::vector<std::string> queries;
+    const std::shared_ptr<ThreadPool> thread_pool;
+    std::vector<Slot> slots;
+
+    std::mutex mutex;
+    std::condition_variable changed; /*!<       */
+    size_t next_query = 0;    /*!<  ,    */
+    size_t read_queries = 0;  /*!<  ,     */
+    size_t running_tasks = 0; /*!<  ,      */
+    bool is_stopped = false;
+
+    std::vector<Document> current; /*!<  ,     */
+    size_t position = 0;
+    bool is_started = false;
+
+    State(const SearchServer& search_server, std::vector<std::string> queries, size_t window)
+        : search_server(search_server)
+        , queries(std::move(queries))
+        , thread_pool(search_server.GetThreadPool() ? search_server.GetThreadPool() : ThreadPool::GetDefault())
+        , slots(std::max<size_t>(1, window))
+    {
+    }
+
+    /*   ,    .   ,
+               */
+    void SubmitQueries() {
+        size_t first;
+        size_t last;
+        {
+            std::lock_guard guard(mutex);
+            if (is_stopped) {
+                return;
+            }
+            first = next_query;
+            last = std::min(queries.size(), read_queries + slots.size());
+            if (first >= last) {
+                return;
+            }
+            next_query = last;
+            running_tasks += last - first;
+        }
+        for (size_t query = first; query < last; ++query) {
+            thread_pool->Submit([this, query]() {
+                RunQuery(query);
+            });
+        }
+    }
+
+    /*   :        */
+    void RunQuery(size_t query) {
+        bool is_skipped;
+        {
+            std::lock_guard guard(mutex);
+            is_skipped = is_stopped;
+        }
+        Slot result;
+        if (!is_skipped) {
+            try {
+                result.documents = search_server.FindTopDocuments(queries[query]);
+            }
+            catch (...) {
+                result.error = std::current_exception();
+            }
+        }
+        result.is_ready = true;
+
+        std::lock_guard guard(mutex);
+        slots[query % slots.size()] = std::move(result);
+        --running_tasks;
+        changed.notify_all();
+    }
+
+    /*      .     */
+    bool TakeNextQuery() {
+        Slot result;
+        {
+            std::unique_lock lock(mutex);
+            if (read_queries == queries.size()) {
+                return false;
+            }
+            Slot& slot = slots[read_queries % slots.size()];
+            changed.wait(lock, [&slot]() {
+                return slot.is_ready;
+            });
+            result = std::move(slot);
+            slot = Slot();
+            ++read_queries;
+        }
+        SubmitQueries();
+
+        if (result.error) {
+            std::rethrow_exception(result.error);
+        }
+        current = std::move(result.documents);
+        position = 0;
+        return true;
+    }
+};
+
+/*! \fn JoinedDocumentStream::JoinedDocumentStream
+ *  \b   \b :   \n
+ *  \b   \b :        ,    ,
+ *                         \n
+ *  \b  \b :      window ,   .
+ *                              \n
+ *  \param[in] search_server   \n
+ *  \param[in] queries  \n
+ *  \param[in] window  ,       \n
+ */
+JoinedDocumentStream::JoinedDocumentStream(const SearchServer& search_server,
+                                           std::vector<std::string> queries,
+                                           size_t window)
+    : state_(std::make_unique<State>(search_server, std::move(queries), window))
+{
+    state_->SubmitQueries();
+}
+
+/*      ,  ,    ,
+    .       */
+JoinedDocumentStream::~JoinedDocumentStream() {
+    if (!state_) {
+        return;
+    }
+    std::unique_lock lock(state_->mutex);
+    state_->is_stopped = true;
+    state_->changed.wait(lock, [this]() {
+        return state_->running_tasks == 0;
+    });
+}
+
+/*! \fn JoinedDocumentStream::begin
+ *  \b   \b :   \n
+ *  \b   \b :   ,      \n
+ *  \b  \b :    , begin    \n
+ *  \return  \n
+ */
+JoinedDocumentStream::Iterator JoinedDocumentStream::begin() {
+    return Advance() ? Iterator(this) : Iterator();
+}
+
+JoinedDocumentStream::Iterator JoinedDocumentStream::end() {
+    return Iterator();
+}
+
+bool JoinedDocumentStream::Advance() {
+    State& state = *state_;
+    if (state.is_started) {
+        ++state.position;
+    }
+    state.is_started = true;
+    while (state.position >= state.current.size()) {
+        if (!state.TakeNextQuery()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const Document& JoinedDocumentStream::GetDocument() const {
+    return state_->current[state_->position];
+}
+
+JoinedDocumentStream::Iterator::Iterator(JoinedDocumentStream* stream)
+    : stream_(stream)
+{
+}
+
+const Document& JoinedDocumentStream::Iterator::operator*() const {
+    return stream_->GetDocument();
+}
+
+const Document* JoinedDocumentStream::Iterator::operator->() const {
+    return &stream_->GetDocument();
+}
+
+JoinedDocumentStream::Iterator& JoinedDocumentStream::Iterator::operator++() {
+    if (!stream_->Advance()) {
+        stream_ = nullptr;
+    }
+    return *this;
+}
+
+bool JoinedDocumentStream::Iterator::operator==(const Iterator& other) const {
+    return stream_ == other.stream_;
+}
+
+bool JoinedDocumentStream::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+/*! \fn ProcessQueriesJoinedStream
+ *  \b   \b :   \n
+ *  \b   \b :           
+ *                       ,     \n
+ *  \b  \b :   ,    ,     \n
+ *  \param[in] search_server   \n
+ *  \param[in] queries  \n
+ *  \param[in] window  ,       \n
+ *  \return      \n
+ */
+JoinedDocumentStream ProcessQueriesJoinedStream(
+    const SearchServer& search_server,
+    std::vector<std::string> queries,
+    size_t window)
+{
+    return JoinedDocumentStream(search_server, std::move(queries), window);
+}
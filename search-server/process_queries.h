@@ -1,14 +1,84 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
+#include <iterator>
 #include <list>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "concurrent_search_server.h"
 #include "search_server.h"
 
+enum class QueryBatchStrategy {
+    PER_QUERY,       /*!<      FindTopDocuments */
+    SHARED_POSTINGS, /*!<          */
+};
+
 std::vector<std::vector<Document>> ProcessQueries(
     const SearchServer& search_server,
-    const std::vector<std::string>& queries);
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy = QueryBatchStrategy::PER_QUERY);
+
+std::vector<std::vector<Document>> ProcessQueries(
+    const ConcurrentSearchServer& search_server,
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy = QueryBatchStrategy::PER_QUERY);
 
 std::list<Document> ProcessQueriesJoined(
     const SearchServer& search_server,
-    const std::vector<std::string>& queries);
\ No newline at end of file
+    const std::vector<std::string>& queries,
+    QueryBatchStrategy strategy = QueryBatchStrategy::PER_QUERY);
+
+const size_t JOINED_REORDER_WINDOW = 1024;
+
+/*      ,    .  
+           window    , 
+         .    ,  
+   ,    */
+class JoinedDocumentStream {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Document;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Document*;
+        using reference = const Document&;
+
+        Iterator() = default;
+        explicit Iterator(JoinedDocumentStream* stream);
+
+        reference operator*() const;
+        pointer operator->() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        JoinedDocumentStream* stream_ = nullptr; /*!<     */
+    };
+
+    JoinedDocumentStream(const SearchServer& search_server,
+                         std::vector<std::string> queries,
+                         size_t window = JOINED_REORDER_WINDOW);
+    JoinedDocumentStream(JoinedDocumentStream&&) = default;
+    JoinedDocumentStream& operator=(JoinedDocumentStream&&) = delete;
+    ~JoinedDocumentStream();
+
+    Iterator begin();
+    Iterator end();
+
+private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+
+    bool Advance();
+    const Document& GetDocument() const;
+};
+
+JoinedDocumentStream ProcessQueriesJoinedStream(
+    const SearchServer& search_server,
+    std::vector<std::string> queries,
+    size_t window = JOINED_REORDER_WINDOW);
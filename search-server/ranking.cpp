@@ -0,0 +1,60 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "ranking.h"
+
+/*! \fn TfIdfRanking::MakeTermScorer
+ *  \b   \b :   \n
+ *  \b   \b :      IDF       \n
+ *  \b  \b :    : IDF     \n
+ *  \param[in] term   \n
+ *  \return   \n
+ */
+TfIdfRanking::TermScorer TfIdfRanking::MakeTermScorer(const CollectionStats&, const TermStats& term) const {
+    return TermScorer(term.inverse_document_freq, term.max_impact);
+}
+
+std::string TfIdfRanking::GetCacheKey() const {
+    return "tf-idf";
+}
+
+/*! \fn Bm25Ranking::Bm25Ranking
+ *  \b   \b :   \n
+ *  \b   \b :    BM25   \n
+ *  \b  \b : k1 , b  [0, 1] \n
+ *  \param[in] k1    \n
+ *  \param[in] b      \n
+ */
+Bm25Ranking::Bm25Ranking(double k1, double b)
+    : k1_(k1)
+    , b_(b)
+{
+    if (!(k1 >= 0.0) || !(b >= 0.0 && b <= 1.0)) {
+        throw std::invalid_argument("BM25 parameters must satisfy k1 >= 0 and 0 <= b <= 1");
+    }
+}
+
+/*! \fn Bm25Ranking::MakeTermScorer
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :     \n
+ *  \param[in] collection   \n
+ *  \param[in] term   \n
+ *  \return   \n
+ */
+Bm25Ranking::TermScorer Bm25Ranking::MakeTermScorer(const CollectionStats& collection, const TermStats& term) const {
+    const double inverse_document_freq = std::log(1.0 +
+        (collection.document_count - term.document_freq + 0.5) / (term.document_freq + 0.5));
+    const double average_length = collection.average_document_length > 0.0 ? collection.average_document_length : 1.0;
+    TermScorer scorer(inverse_document_freq * (k1_ + 1.0), k1_ * (1.0 - b_), k1_ * b_ / average_length);
+    scorer.max_impact_ = scorer.GetBlockMaxScore(term.max_term_freq);
+    return scorer;
+}
+
+std::string Bm25Ranking::GetCacheKey() const {
+    std::ostringstream key;
+    key.precision(17);
+    key << "bm25 " << k1_ << ' ' << b_;
+    return key.str();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+
+#include "inverted_index.h"
+
+/*       */
+struct CollectionStats {
+    int document_count = 0;
+    double average_document_length = 0.0; /*!<      */
+};
+
+/*       */
+struct TermStats {
+    int document_freq = 0;              /*!<      */
+    double inverse_document_freq = 0.0; /*!< IDF     */
+    double max_term_freq = 0.0;         /*!<      */
+    double max_impact = 0.0;            /*!< max_term_freq * inverse_document_freq */
+};
+
+/*       ,    
+          .     
+    TermScorer   :
+   Score(posting) -     ,     ;
+   GetBlockMaxScore(max_term_freq) -         ;
+   GetMaxImpact() -       .
+   GetCacheKey          */
+
+/* TF-IDF:    ,   IDF */
+class TfIdfRanking {
+public:
+    class TermScorer {
+    public:
+        TermScorer(double inverse_document_freq, double max_impact)
+            : inverse_document_freq_(inverse_document_freq)
+            , max_impact_(max_impact)
+        {
+        }
+
+        double Score(const InvertedIndex::PostingIterator& posting) const {
+            return posting.GetTermFreq() * inverse_document_freq_;
+        }
+
+        double GetBlockMaxScore(double max_term_freq) const {
+            return max_term_freq * inverse_document_freq_;
+        }
+
+        double GetMaxImpact() const {
+            return max_impact_;
+        }
+
+    private:
+        double inverse_document_freq_;
+        double max_impact_;
+    };
+
+    TermScorer MakeTermScorer(const CollectionStats& collection, const TermStats& term) const;
+    std::string GetCacheKey() const;
+};
+
+/* Okapi BM25: idf * count * (k1 + 1) / (count + k1 * (1 - b + b * length / average_length)),
+    idf = log(1 + (N - df + 0.5) / (df + 0.5)).     
+   k1,      b */
+class Bm25Ranking {
+public:
+    static constexpr double DEFAULT_K1 = 1.2;
+    static constexpr double DEFAULT_B = 0.75;
+
+    class TermScorer {
+    public:
+        TermScorer(double weight, double length_norm, double average_length_norm)
+            : weight_(weight)
+            , length_norm_(length_norm)
+            , average_length_norm_(average_length_norm)
+        {
+        }
+
+        /*   - ,       */
+        double Score(const InvertedIndex::PostingIterator& posting) const {
+            const double count = posting.GetCount();
+            return weight_ * count / (count + length_norm_ + average_length_norm_ / posting.GetInverseDocumentLength());
+        }
+
+        /*   r = count / length   weight * r / (r + length_norm / length +
+           average_length_norm),    r      length_norm = 0 */
+        double GetBlockMaxScore(double max_term_freq) const {
+            return max_term_freq > 0.0 ? weight_ * max_term_freq / (max_term_freq + average_length_norm_) : 0.0;
+        }
+
+        double GetMaxImpact() const {
+            return max_impact_;
+        }
+
+    private:
+        friend class Bm25Ranking;
+
+        double weight_;              /*!< idf * (k1 + 1) */
+        double length_norm_;         /*!< k1 * (1 - b) */
+        double average_length_norm_; /*!< k1 * b / average_length */
+        double max_impact_ = 0.0;
+    };
+
+    explicit Bm25Ranking(double k1 = DEFAULT_K1, double b = DEFAULT_B);
+
+    TermScorer MakeTermScorer(const CollectionStats& collection, const TermStats& term) const;
+    std::string GetCacheKey() const;
+
+private:
+    double k1_;
+    double b_;
+};
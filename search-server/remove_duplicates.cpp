@@ -1,40 +1,243 @@
-#include <map>
-#include <set>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "remove_duplicates.h"
 
-/*! \fn RemoveDuplicates
+namespace {
+
+/* Отпечаток множества слов: суммы двух независимых хэшей слов, не зависят от порядка слов */
+struct Fingerprint {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const Fingerprint& other) const {
+        return low == other.low && high == other.high;
+    }
+};
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint& fingerprint) const {
+        return static_cast<size_t>(fingerprint.low);
+    }
+};
+
+struct DocumentSignature {
+    Fingerprint fingerprint;
+    std::vector<uint64_t> minhashes; /*!< Пуст при поиске только точных дубликатов */
+};
+
+/* Разбиение MinHash на полосы: документы с совпавшей хотя бы одной полосой сравниваются точно */
+struct LshBands {
+    size_t band_count = 0;
+    size_t rows_per_band = 0;
+};
+
+/* Перемешивание из splitmix64, чтобы суммы и минимумы хэшей слов были независимы */
+uint64_t MixHash(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+DocumentSignature ComputeSignature(const std::map<std::string_view, double>& word_freqs, bool with_minhashes) {
+    static const uint64_t HIGH_SEED = 0x2545f4914f6cdd1dULL;
+
+    DocumentSignature signature;
+    if (with_minhashes) {
+        signature.minhashes.assign(MINHASH_SIZE, std::numeric_limits<uint64_t>::max());
+    }
+    for (const auto& [word, frequency] : word_freqs) {
+        const uint64_t hash = std::hash<std::string_view>{}(word);
+        signature.fingerprint.low += MixHash(hash);
+        signature.fingerprint.high += MixHash(hash ^ HIGH_SEED);
+        for (size_t i = 0; i < signature.minhashes.size(); ++i) {
+            signature.minhashes[i] = std::min(signature.minhashes[i], MixHash(hash + i * HIGH_SEED));
+        }
+    }
+    return signature;
+}
+
+/*! \fn ChooseLshBands
  *  \b Компонента  \b : Поисковой сервер \n
- *  \b Назначение  \b : Удаление дубликатов документов из поискового сервера.
- *                      Среди двух дубликатов удаляется документ с большим id \n
- *  \b Ограничения \b : Нет \n
- *  \param[in] search_server поисковый сервер
- *  \return Нет
+ *  \b Назначение  \b : Выбор самых длинных полос, при которых пара документов с мерой Жаккара,
+ *                      равной порогу, становится кандидатом с вероятностью не меньше 99%.
+ *                      Чем длиннее полосы, тем меньше лишних кандидатов \n
+ *  \b Ограничения \b : Порог не меньше MIN_JACCARD_THRESHOLD, при меньших порогах даже полосы
+ *                      из одного значения дают полноту ниже 99% \n
+ *  \param[in] jaccard_threshold порог меры Жаккара \n
+ *  \return разбиение на полосы \n
  */
-void RemoveDuplicates(SearchServer& search_server) {
-    std::set<std::set<std::string>> documents;
-    std::set<int> duplicate_documents_id;
-
-    for (const int document_id : search_server) {
-        const std::map<std::string, double>& document =
-            search_server.GetWordFrequencies(document_id);
-        std::set<std::string> words_in_document;
+LshBands ChooseLshBands(double jaccard_threshold) {
+    static const double MIN_RECALL = 0.99;
 
-        for (const auto& [word, frequency] : document) {
-            words_in_document.insert(word);
+    LshBands result{ MINHASH_SIZE, 1 };
+    for (size_t rows_per_band = 2; rows_per_band <= MINHASH_SIZE; rows_per_band *= 2) {
+        const size_t band_count = MINHASH_SIZE / rows_per_band;
+        const double recall = 1.0 - std::pow(1.0 - std::pow(jaccard_threshold, rows_per_band), band_count);
+        if (recall < MIN_RECALL) {
+            break;
         }
+        result = { band_count, rows_per_band };
+    }
+    return result;
+}
+
+uint64_t ComputeBandHash(const std::vector<uint64_t>& minhashes, const LshBands& bands, size_t band) {
+    uint64_t hash = band;
+    for (size_t i = band * bands.rows_per_band; i < (band + 1) * bands.rows_per_band; ++i) {
+        hash = MixHash(hash ^ minhashes[i]);
+    }
+    return hash;
+}
 
-        if (documents.count(words_in_document)) {
-            duplicate_documents_id.insert(document_id);
+bool HasSameWords(const std::map<std::string_view, double>& lhs,
+                  const std::map<std::string_view, double>& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+        [](const auto& lhs_word, const auto& rhs_word) {return lhs_word.first == rhs_word.first;});
+}
+
+double ComputeJaccard(const std::map<std::string_view, double>& lhs,
+                      const std::map<std::string_view, double>& rhs)
+{
+    if (lhs.empty() && rhs.empty()) {
+        return 1.0;
+    }
+    size_t common_count = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (lhs_it->first < rhs_it->first) {
+            ++lhs_it;
+        }
+        else if (rhs_it->first < lhs_it->first) {
+            ++rhs_it;
         }
         else {
-            documents.insert(words_in_document);
+            ++common_count;
+            ++lhs_it;
+            ++rhs_it;
         }
     }
+    return static_cast<double>(common_count) / (lhs.size() + rhs.size() - common_count);
+}
+
+template <typename Function>
+void RunParallel(const SearchServer& search_server, size_t count, Function function) {
+    if (const std::shared_ptr<ThreadPool> thread_pool = search_server.GetThreadPool()) {
+        thread_pool->ParallelFor(count, function);
+        return;
+    }
+    std::vector<size_t> indexes(count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.cbegin(), indexes.cend(), function);
+}
+
+} // namespace
+
+/*! \fn FindDuplicates
+ *  \b Компонента  \b : Поисковой сервер \n
+ *  \b Назначение  \b : Поиск дубликатов документов. Отпечатки и MinHash множеств слов
+ *                      вычисляются параллельно. Точные дубликаты находятся по отпечаткам,
+ *                      почти дубликаты - по совпадению полос MinHash, кандидаты в обоих случаях
+ *                      проверяются сравнением множеств слов. Среди дубликатов остаётся
+ *                      документ с меньшим id \n
+ *  \b Ограничения \b : Порог меры Жаккара должен быть в [MIN_JACCARD_THRESHOLD, 1]. Почти
+ *                      дубликат с мерой не ниже порога пропускается с вероятностью не больше 1%,
+ *                      лишних документов не бывает \n
+ *  \param[in] search_server поисковый сервер \n
+ *  \param[in] options параметры поиска \n
+ *  \return идентификаторы дубликатов по возрастанию \n
+ */
+std::vector<int> FindDuplicates(SearchServer& search_server, const DuplicateSearchOptions& options) {
+    if (!(options.jaccard_threshold >= MIN_JACCARD_THRESHOLD && options.jaccard_threshold <= 1.0)) {
+        throw std::invalid_argument("Jaccard threshold must be in [" + std::to_string(MIN_JACCARD_THRESHOLD) + ", 1]");
+    }
+    const bool is_exact = options.jaccard_threshold == 1.0;
+
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    std::vector<const std::map<std::string_view, double>*> word_freqs(document_ids.size());
+    std::vector<DocumentSignature> signatures(document_ids.size());
+    RunParallel(search_server, document_ids.size(),
+        [&search_server, &document_ids, &word_freqs, &signatures, is_exact](size_t i) {
+            word_freqs[i] = &search_server.GetWordFrequencies(document_ids[i]);
+            signatures[i] = ComputeSignature(*word_freqs[i], !is_exact);
+        });
+
+    const LshBands bands = ChooseLshBands(options.jaccard_threshold);
+    std::unordered_map<Fingerprint, std::vector<size_t>, FingerprintHash> fingerprint_to_documents;
+    std::vector<std::unordered_map<uint64_t, std::vector<size_t>>> band_to_documents(is_exact ? 0 : bands.band_count);
+    std::vector<size_t> last_checked(document_ids.size(), document_ids.size());
+    std::vector<int> result;
+
+    for (size_t i = 0; i < document_ids.size(); ++i) {
+        auto& same_fingerprint = fingerprint_to_documents[signatures[i].fingerprint];
+        const bool is_duplicate = std::any_of(same_fingerprint.begin(), same_fingerprint.end(),
+            [&word_freqs, i](size_t kept) {return HasSameWords(*word_freqs[kept], *word_freqs[i]);});
+        if (is_duplicate) {
+            result.push_back(document_ids[i]);
+            continue;
+        }
 
-    for (const int document_id : duplicate_documents_id) {
-        search_server.RemoveDocument(document_id);
-        std::cout << "Found duplicate document id " << document_id << std::endl;
+        bool is_near_duplicate = false;
+        std::vector<uint64_t> band_hashes(band_to_documents.size());
+        for (size_t band = 0; band < band_to_documents.size(); ++band) {
+            band_hashes[band] = ComputeBandHash(signatures[i].minhashes, bands, band);
+            const auto iterator = band_to_documents[band].find(band_hashes[band]);
+            if (iterator == band_to_documents[band].end()) {
+                continue;
+            }
+            for (const size_t kept : iterator->second) {
+                if (last_checked[kept] == i) {
+                    continue;
+                }
+                last_checked[kept] = i;
+                if (ComputeJaccard(*word_freqs[kept], *word_freqs[i]) >= options.jaccard_threshold) {
+                    is_near_duplicate = true;
+                    break;
+                }
+            }
+            if (is_near_duplicate) {
+                break;
+            }
+        }
+        if (is_near_duplicate) {
+            result.push_back(document_ids[i]);
+            continue;
+        }
+
+        same_fingerprint.push_back(i);
+        for (size_t band = 0; band < band_to_documents.size(); ++band) {
+            band_to_documents[band][band_hashes[band]].push_back(i);
+        }
+    }
+    return result;
+}
+
+/*! \fn RemoveDuplicates
+ *  \b Компонента  \b : Поисковой сервер \n
+ *  \b Назначение  \b : Удаление дубликатов документов из поискового сервера.
+ *                      Среди дубликатов удаляются документы с большим id \n
+ *  \b Ограничения \b : Нет \n
+ *  \param[in] search_server поисковый сервер \n
+ *  \param[in] options параметры поиска дубликатов и вывод удалённых документов \n
+ *  \return Нет \n
+ */
+void RemoveDuplicates(SearchServer& search_server, const DuplicateSearchOptions& options) {
+    const std::vector<int> duplicate_document_ids = FindDuplicates(search_server, options);
+    search_server.RemoveDocuments(duplicate_document_ids);
+    if (options.log != nullptr) {
+        for (const int document_id : duplicate_document_ids) {
+            *options.log << "Found duplicate document id " << document_id << '\n';
+        }
+        options.log->flush();
     }
 }
@@ -1,5 +1,25 @@
 #pragma once
 
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
 #include "search_server.h"
 
-void RemoveDuplicates(SearchServer& search_server);
+const size_t MINHASH_SIZE = 128;
+/*!    :    MINHASH_SIZE  MinHash  
+     99%      .   0.05  1 - 0.95^128 > 99.8% */
+const double MIN_JACCARD_THRESHOLD = 0.05;
+
+struct DuplicateSearchOptions {
+    /*!     ,      ,
+         MIN_JACCARD_THRESHOLD  1.0.  1.0        */
+    double jaccard_threshold = 1.0;
+    std::ostream* log = &std::cout; /*!<   ,  ,   */
+};
+
+std::vector<int> FindDuplicates(SearchServer& search_server,
+                                const DuplicateSearchOptions& options = {});
+
+void RemoveDuplicates(SearchServer& search_server,
+                      const DuplicateSearchOptions& options = {});
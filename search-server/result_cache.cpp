@@ -0,0 +1,77 @@
+#include <functional>
+
+#include "result_cache.h"
+
+/*! \fn ResultCache::ResultCache
+ *  \b   \b :   \n
+ *  \b   \b :  ,         \n
+ *  \b  \b :  \n
+ *  \param[in] capacity    \n
+ */
+ResultCache::ResultCache(size_t capacity)
+    : capacity_(capacity)
+{
+    shards_.reserve(SHARD_COUNT);
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        shards_.push_back(std::make_unique<Shard>((capacity + SHARD_COUNT - 1) / SHARD_COUNT));
+    }
+}
+
+/*! \fn ResultCache::Find
+ *  \b   \b :   \n
+ *  \b   \b :  ,       \n
+ *  \b  \b :    \n
+ *  \param[in] key   \n
+ *  \return       \n
+ */
+std::optional<std::vector<Document>> ResultCache::Find(const std::string& key) {
+    Shard& shard = GetShard(key);
+    {
+        std::lock_guard guard(shard.mutex);
+        if (const auto* documents = shard.entries.Find(key)) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return *documents;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+/*! \fn ResultCache::Put
+ *  \b   \b :   \n
+ *  \b   \b :  ,       \n
+ *  \b  \b :    \n
+ *  \param[in] key   \n
+ *  \param[in] documents   \n
+ *  \return  \n
+ */
+void ResultCache::Put(const std::string& key, std::vector<Document> documents) {
+    Shard& shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    if (shard.entries.Put(key, std::move(documents))) {
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*! \fn ResultCache::GetStats
+ *  \b   \b :   \n
+ *  \b   \b :  ,       \n
+ *  \b  \b :       \n
+ *  \return   \n
+ */
+ResultCache::Stats ResultCache::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.capacity = capacity_;
+    for (const auto& shard : shards_) {
+        std::lock_guard guard(shard->mutex);
+        stats.size += shard->entries.GetSize();
+    }
+    return stats;
+}
+
+ResultCache::Shard& ResultCache::GetShard(const std::string& key) {
+    return *shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "document.h"
+#include "lru_cache.h"
+
+/*      .  
+        ,        */
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    explicit ResultCache(size_t capacity);
+
+    std::optional<std::vector<Document>> Find(const std::string& key);
+    void Put(const std::string& key, std::vector<Document> documents);
+    Stats GetStats() const;
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Shard {
+        explicit Shard(size_t capacity)
+            : entries(capacity)
+        {
+        }
+
+        mutable std::mutex mutex;
+        LruCache<std::string, std::vector<Document>> entries;
+    };
+
+    size_t capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+    std::atomic<uint64_t> evictions_{ 0 };
+
+    Shard& GetShard(const std::string& key);
+};
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <deque>
+
+#include "scoring_workspace.h"
+
+namespace {
+
+/*   .         */
+thread_local std::deque<ScoringWorkspace> thread_workspaces;
+thread_local size_t thread_workspaces_in_use = 0;
+
+} // namespace
+
+/*! \fn ScoringWorkspace::Lease::Lease
+ *  \b   \b :   \n
+ *  \b   \b :        .
+ *                              \n
+ *  \b  \b :  \n
+ *  \param[in] document_count     \n
+ */
+ScoringWorkspace::Lease::Lease(size_t document_count) {
+    if (thread_workspaces_in_use == thread_workspaces.size()) {
+        thread_workspaces.emplace_back();
+    }
+    workspace_ = &thread_workspaces[thread_workspaces_in_use];
+    ++thread_workspaces_in_use;
+    workspace_->Prepare(document_count);
+}
+
+ScoringWorkspace::Lease::~Lease() {
+    workspace_->Reset();
+    --thread_workspaces_in_use;
+}
+
+ScoringWorkspace& ScoringWorkspace::Lease::operator*() const {
+    return *workspace_;
+}
+
+ScoringWorkspace* ScoringWorkspace::Lease::operator->() const {
+    return workspace_;
+}
+
+/*! \fn ScoringWorkspace::Veto
+ *  \b   \b :   \n
+ *  \b   \b :    -   \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \return  \n
+ */
+void ScoringWorkspace::Veto(int document_id) {
+    uint8_t& flags = flags_[document_id];
+
+    if (flags == 0) {
+        touched_.push_back(document_id);
+    }
+    flags |= VETOED;
+}
+
+bool ScoringWorkspace::IsVetoed(int document_id) const {
+    return (flags_[document_id] & VETOED) != 0;
+}
+
+size_t ScoringWorkspace::GetTouchedCount() const {
+    return touched_.size();
+}
+
+void ScoringWorkspace::Prepare(size_t document_count) {
+    if (flags_.size() < document_count) {
+        relevance_.resize(document_count);
+        flags_.resize(document_count);
+    }
+}
+
+void ScoringWorkspace::Reset() {
+    /*          */
+    if (touched_.size() > flags_.size() / 8) {
+        std::fill(flags_.begin(), flags_.end(), 0);
+    }
+    else {
+        for (const int document_id : touched_) {
+            flags_[document_id] = 0;
+        }
+    }
+    touched_.clear();
+}
+
+namespace {
+
+thread_local std::deque<BatchScoringWorkspace> thread_batch_workspaces;
+thread_local size_t thread_batch_workspaces_in_use = 0;
+
+} // namespace
+
+/*! \fn BatchScoringWorkspace::Lease::Lease
+ *  \b   \b :   \n
+ *  \b   \b :        \n
+ *  \b  \b :        \n
+ *  \param[in] document_count     \n
+ *  \param[in] query_count     \n
+ */
+BatchScoringWorkspace::Lease::Lease(size_t document_count, size_t query_count) {
+    if (thread_batch_workspaces_in_use == thread_batch_workspaces.size()) {
+        thread_batch_workspaces.emplace_back();
+    }
+    workspace_ = &thread_batch_workspaces[thread_batch_workspaces_in_use];
+    ++thread_batch_workspaces_in_use;
+    workspace_->Prepare(document_count, query_count);
+}
+
+BatchScoringWorkspace::Lease::~Lease() {
+    workspace_->Reset();
+    --thread_batch_workspaces_in_use;
+}
+
+BatchScoringWorkspace& BatchScoringWorkspace::Lease::operator*() const {
+    return *workspace_;
+}
+
+BatchScoringWorkspace* BatchScoringWorkspace::Lease::operator->() const {
+    return workspace_;
+}
+
+void BatchScoringWorkspace::Veto(int document_id, size_t query) {
+    uint8_t& flags = flags_[document_id * query_count_ + query];
+
+    if (flags == 0) {
+        touched_[query].push_back(document_id);
+    }
+    flags |= VETOED;
+}
+
+/*     Lease,      
+       */
+void BatchScoringWorkspace::Prepare(size_t document_count, size_t query_count) {
+    query_count_ = query_count;
+    if (flags_.size() < document_count * query_count) {
+        relevance_.resize(document_count * query_count);
+        flags_.resize(document_count * query_count);
+    }
+    if (touched_.size() < query_count) {
+        touched_.resize(query_count);
+    }
+}
+
+void BatchScoringWorkspace::Reset() {
+    for (size_t query = 0; query < query_count_; ++query) {
+        for (const int document_id : touched_[query]) {
+            flags_[document_id * query_count_ + query] = 0;
+        }
+        touched_[query].clear();
+    }
+}
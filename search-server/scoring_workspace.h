@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class ScoringWorkspace {
+public:
+    class Lease {
+    public:
+        explicit Lease(size_t document_count);
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        ScoringWorkspace& operator*() const;
+        ScoringWorkspace* operator->() const;
+
+    private:
+        ScoringWorkspace* workspace_;
+    };
+
+    void Veto(int document_id);
+    bool IsVetoed(int document_id) const;
+
+    template <typename DocumentFilter>
+    void Add(int document_id, double relevance, DocumentFilter document_filter);
+
+    template <typename Function>
+    void ForEachScored(Function function) const;
+
+    size_t GetTouchedCount() const;
+
+private:
+    enum : uint8_t {
+        SCORED = 1,   /*!<       */
+        REJECTED = 2, /*!<     */
+        VETOED = 4,   /*!<   - */
+    };
+
+    std::vector<double> relevance_;
+    std::vector<uint8_t> flags_;
+    std::vector<int> touched_;
+
+    void Prepare(size_t document_count);
+    void Reset();
+};
+
+/*! \fn ScoringWorkspace::Add
+ *  \b   \b :   \n
+ *  \b   \b :   .    
+ *                         ,   -  \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \param[in] relevance   \n
+ *  \param[in] document_filter  ,    \n
+ *  \return  \n
+ */
+template <typename DocumentFilter>
+void ScoringWorkspace::Add(int document_id, double relevance, DocumentFilter document_filter) {
+    uint8_t& flags = flags_[document_id];
+
+    if (flags & SCORED) {
+        relevance_[document_id] += relevance;
+        return;
+    }
+    if (flags != 0) {
+        return;
+    }
+    touched_.push_back(document_id);
+    if (document_filter(document_id)) {
+        flags = SCORED;
+        relevance_[document_id] = relevance;
+    }
+    else {
+        flags = REJECTED;
+    }
+}
+
+template <typename Function>
+void ScoringWorkspace::ForEachScored(Function function) const {
+    for (const int document_id : touched_) {
+        if (flags_[document_id] == SCORED) {
+            function(document_id, relevance_[document_id]);
+        }
+    }
+}
+
+/*    .      ,
+       ,    ,     */
+class BatchScoringWorkspace {
+public:
+    class Lease {
+    public:
+        Lease(size_t document_count, size_t query_count);
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        BatchScoringWorkspace& operator*() const;
+        BatchScoringWorkspace* operator->() const;
+
+    private:
+        BatchScoringWorkspace* workspace_;
+    };
+
+    void Veto(int document_id, size_t query);
+
+    template <typename DocumentFilter>
+    void Add(int document_id, size_t query, double relevance, DocumentFilter document_filter);
+
+    template <typename Function>
+    void ForEachScored(size_t query, Function function) const;
+
+private:
+    enum : uint8_t {
+        SCORED = 1,
+        REJECTED = 2,
+        VETOED = 4,
+    };
+
+    size_t query_count_ = 0;
+    std::vector<double> relevance_;          /*!<   query  document_id
+                                                   relevance_[document_id * query_count_ + query] */
+    std::vector<uint8_t> flags_;
+    std::vector<std::vector<int>> touched_;  /*!<        */
+
+    void Prepare(size_t document_count, size_t query_count);
+    void Reset();
+};
+
+/*! \fn BatchScoringWorkspace::Add
+ *  \b   \b :   \n
+ *  \b   \b :      ,   ScoringWorkspace::Add \n
+ *  \b  \b :  \n
+ *  \param[in] document_id    \n
+ *  \param[in] query     \n
+ *  \param[in] relevance   \n
+ *  \param[in] document_filter  ,    \n
+ *  \return  \n
+ */
+template <typename DocumentFilter>
+void BatchScoringWorkspace::Add(int document_id, size_t query, double relevance, DocumentFilter document_filter) {
+    const size_t index = document_id * query_count_ + query;
+    uint8_t& flags = flags_[index];
+
+    if (flags & SCORED) {
+        relevance_[index] += relevance;
+        return;
+    }
+    if (flags != 0) {
+        return;
+    }
+    touched_[query].push_back(document_id);
+    if (document_filter(document_id)) {
+        flags = SCORED;
+        relevance_[index] = relevance;
+    }
+    else {
+        flags = REJECTED;
+    }
+}
+
+template <typename Function>
+void BatchScoringWorkspace::ForEachScored(size_t query, Function function) const {
+    for (const int document_id : touched_[query]) {
+        const size_t index = document_id * query_count_ + query;
+        if (flags_[index] == SCORED) {
+            function(document_id, relevance_[index]);
+        }
+    }
+}
@@ -1,8 +1,14 @@
 #include <cmath>
+#include <functional>
 #include <numeric>
+#include <set>
 
 #include "search_server.h"
 
+const std::string& PreparedQuery::GetText() const {
+    return text_;
+}
+
 SearchServer::SearchServer(const std::string& stop_words_text)
     : SearchServer(SplitIntoWords(stop_words_text))
 {
@@ -13,12 +19,77 @@ SearchServer::SearchServer(const std::string_view stop_words_text)
 {
 }
 
-std::set<int>::iterator SearchServer::begin() {
-    return document_ids_.begin();
+/*! \fn SearchServer::SearchServer
+ *  \b   \b :   \n
+ *  \b   \b :     ,  Save.   
+ *                          ,      ,
+ *                               \n
+ *  \b  \b :  ,    ,  
+ *                       ,    , 
+ *                        .      
+ *                         verify_checksums \n
+ *  \param[in] index_file    \n
+ *  \param[in] verify_checksums      \n
+ */
+SearchServer::SearchServer(std::shared_ptr<const MappedFile> index_file, bool verify_checksums)
+    : SearchServer(IndexFileReader(std::move(index_file), verify_checksums))
+{
+}
+
+SearchServer::SearchServer(const IndexFileReader& reader)
+    : stop_words_(ReadStopWords(reader))
+    , stop_word_set_(stop_words_)
+    , index_file_(reader.GetFile())
+    , is_mapped_(true)
+{
+    MappedDocuments& mapped = mapped_documents_;
+    mapped.documents = reader.GetSection<DocumentData>(IndexSection::DOCUMENTS);
+    mapped.sorted_document_ids = reader.GetSection<int>(IndexSection::SORTED_DOCUMENT_IDS);
+    mapped.sorted_internal_ids = reader.GetSection<int>(IndexSection::SORTED_INTERNAL_IDS);
+    mapped.text_chars = reader.GetSection<char>(IndexSection::TEXT_CHARS);
+    mapped.text_offsets = reader.GetSection<uint64_t>(IndexSection::TEXT_OFFSETS);
+    mapped.forward_offsets = reader.GetSection<uint64_t>(IndexSection::FORWARD_OFFSETS);
+    mapped.forward_term_ids = reader.GetSection<int>(IndexSection::FORWARD_TERM_IDS);
+    mapped.forward_term_freqs = reader.GetSection<double>(IndexSection::FORWARD_TERM_FREQS);
+
+    const size_t document_count = mapped.documents.size();
+    if (mapped.sorted_document_ids.size() != document_count ||
+        mapped.sorted_internal_ids.size() != document_count ||
+        std::adjacent_find(mapped.sorted_document_ids.begin(), mapped.sorted_document_ids.end(),
+            std::greater_equal<int>()) != mapped.sorted_document_ids.end() ||
+        std::any_of(mapped.sorted_internal_ids.begin(), mapped.sorted_internal_ids.end(), [document_count](int internal_id) {
+            return internal_id < 0 || static_cast<size_t>(internal_id) >= document_count;
+        }) ||
+        mapped.text_offsets.size() != document_count + 1 ||
+        !AreValidOffsets(mapped.text_offsets, mapped.text_chars.size()) ||
+        mapped.forward_offsets.size() != document_count + 1 ||
+        !AreValidOffsets(mapped.forward_offsets, mapped.forward_term_ids.size()) ||
+        mapped.forward_term_freqs.size() != mapped.forward_term_ids.size()) {
+        throw std::invalid_argument("Index file documents are corrupted");
+    }
+    index_.Map(reader, static_cast<int>(document_count));
+    term_weights_.Invalidate(index_.GetTermCount());
+}
+
+SearchServer::WordFrequenciesCache::WordFrequenciesCache(const WordFrequenciesCache&) {
+}
+
+SearchServer::WordFrequenciesCache& SearchServer::WordFrequenciesCache::operator=(const WordFrequenciesCache& other) {
+    if (this != &other) {
+        std::lock_guard guard(mutex);
+        word_freqs.clear();
+    }
+    return *this;
+}
+
+SearchServer::DocumentIdIterator SearchServer::begin() {
+    Detach();
+    return document_to_internal_id_.BeginKeys();
 }
 
-std::set<int>::iterator SearchServer::end() {
-    return document_ids_.end();
+SearchServer::DocumentIdIterator SearchServer::end() {
+    Detach();
+    return document_to_internal_id_.EndKeys();
 }
 
 void SearchServer::AddDocument(int document_id,
@@ -26,71 +97,294 @@ void SearchServer::AddDocument(int document_id,
                                DocumentStatus status,
                                const std::vector<int>& ratings)
 {
-    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+    Detach();
+    if ((document_id < 0) || (document_to_internal_id_.Find(document_id) != nullptr)) {
         throw std::invalid_argument("Invalid document_id");
     }
 
-    const auto it = all_documenst_.insert(std::string(document));
-    const auto words = SplitIntoWordsNoStop(*(it.first));
-    const double inv_word_count = 1.0 / words.size();
+    const auto words = SplitIntoWordsNoStop(document);
+    document_texts_.push_back(document_chars_.Add(document));
+    const int internal_id = static_cast<int>(documents_.size());
+    std::vector<int> term_ids;
+    std::vector<std::pair<int, int>> term_counts;
+    term_ids.reserve(words.size());
+    term_counts.reserve(words.size());
     for (const auto &word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][word] += inv_word_count;
+        term_ids.push_back(index_.AddTerm(word));
+        term_counts.emplace_back(term_ids.back(), 1);
     }
-    documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), status});
-    document_ids_.insert(document_id);
+    index_.AddDocument(internal_id, term_ids);
+    document_terms_.push_back(MakeDocumentTerms(std::move(term_counts), static_cast<int>(words.size())));
+    documents_.push_back({document_id, ComputeAverageRating(ratings), status});
+    document_to_internal_id_.Insert(document_id, internal_id);
+    UpdateGeneration();
+}
+
+/*! \fn SearchServer::AddDocuments
+ *  \b   \b :   \n
+ *  \b   \b :   AddDocuments \n
+ *                        AddDocuments(execution::seq, documents) \n
+ *  \b  \b :  \n
+ *  \param[in] documents  \n
+ *  \return  \n
+ */
+void SearchServer::AddDocuments(const std::vector<RawDocument>& documents) {
+    AddDocuments(std::execution::seq, documents);
+}
+
+/*! \fn SearchServer::AddDocuments
+ *  \b   \b :   \n
+ *  \b   \b :   .    
+ *                       AddDocument,      
+ *                          \n
+ *  \b  \b :           \n
+ *  \param[in] documents  \n
+ *  \return  \n
+ */
+void SearchServer::AddDocuments(const std::execution::sequenced_policy&,
+                                const std::vector<RawDocument>& documents)
+{
+    Detach();
+    CheckNewDocumentIds(documents);
+
+    std::vector<PreparedDocument> prepared_documents(documents.size());
+    std::transform(documents.begin(), documents.end(), prepared_documents.begin(),
+        [this](const RawDocument& document) {return PrepareDocument(document);});
+    AddPreparedDocuments(documents, prepared_documents);
+}
+
+/*! \fn SearchServer::AddDocuments
+ *  \b   \b :   \n
+ *  \b   \b :   AddDocuments.     
+ *                         \n
+ *  \b  \b :           \n
+ *  \param[in] documents  \n
+ *  \return  \n
+ */
+void SearchServer::AddDocuments(const std::execution::parallel_policy&,
+                                const std::vector<RawDocument>& documents)
+{
+    Detach();
+    CheckNewDocumentIds(documents);
+
+    std::vector<PreparedDocument> prepared_documents(documents.size());
+    RunParallel(documents.size(), [this, &documents, &prepared_documents](size_t i) {
+        prepared_documents[i] = PrepareDocument(documents[i]);
+    });
+    AddPreparedDocuments(documents, prepared_documents);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query,
                                                      DocumentStatus status) const
 {
-    return FindTopDocuments(std::execution::seq,
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
+    return FindTopDocuments(std::execution::seq, raw_query, status);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query) const {
     return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
 }
 
-int SearchServer::GetDocumentCount() const {
-    return static_cast<size_t>(documents_.size());
-}
-
-std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
-    const std::string& raw_query,
-    int document_id) const
+/*! \fn SearchServer::FindTopDocumentsBatch
+ *  \b   \b :   \n
+ *  \b   \b :       .   
+ *                         ,      
+ *                          .     , 
+ *                              ,    
+ *                       .   ,   
+ *                      ,        \n
+ *  \b  \b :    FindTopDocuments(query)   .
+ *                          \n
+ *  \param[in] raw_queries   \n
+ *  \return      \n
+ */
+std::vector<std::vector<Document>> SearchServer::FindTopDocumentsBatch(
+    const std::vector<std::string>& raw_queries) const
 {
-    if (0 == document_ids_.count(document_id)) {
-        throw std::out_of_range("There is no document with this document_id");
-    }
+    /*     QUERY_GROUP_SIZE       */
+    static const size_t QUERY_GROUP_SIZE = 4;
 
-    const Query query = ParseQuery(raw_query);
+    /*     -:  -  -   */
+    using TermKey = std::pair<int, bool>;
 
-    bool minus_word_is = std::any_of(query.minus_words.begin(), query.minus_words.end(),
-        [this, document_id](std::string_view word) {
-            return word_to_document_freqs_.count(word) &&
-                word_to_document_freqs_.at(word).count(document_id);
-        });
+    struct QueryGroup {
+        std::vector<const PreparedQuery*> queries;
+        std::vector<std::vector<Document>*> results;
+        std::set<TermKey> terms;
+        size_t cost = 0; /*!<      */
+    };
+
+    std::vector<std::shared_ptr<const PreparedQuery>> prepared_queries(raw_queries.size());
+    RunParallel(raw_queries.size(), [this, &raw_queries, &prepared_queries](size_t i) {
+        prepared_queries[i] = GetPreparedQuery(raw_queries[i]);
+    });
+
+    std::vector<std::vector<TermKey>> query_terms(prepared_queries.size());
+    std::vector<std::pair<size_t, size_t>> query_order;
+    query_order.reserve(prepared_queries.size());
+    for (size_t i = 0; i < prepared_queries.size(); ++i) {
+        for (const PreparedQuery::Term& term : prepared_queries[i]->plus_terms_) {
+            query_terms[i].emplace_back(term.term_id, false);
+        }
+        for (const int term_id : prepared_queries[i]->minus_term_ids_) {
+            query_terms[i].emplace_back(term_id, true);
+        }
+        std::sort(query_terms[i].begin(), query_terms[i].end());
+        query_terms[i].erase(std::unique(query_terms[i].begin(), query_terms[i].end()), query_terms[i].end());
 
-    if (minus_word_is) {
-        return {{}, documents_.at(document_id).status};
+        size_t cost = 0;
+        for (const TermKey& term : query_terms[i]) {
+            cost += index_.GetDocumentFreq(term.first);
+        }
+        query_order.emplace_back(cost, i);
     }
-    else {
-        std::vector<std::string_view> matched_words;
+    std::sort(query_order.begin(), query_order.end(), [](const auto& lhs, const auto& rhs) {
+        return std::pair(rhs.first, lhs.second) < std::pair(lhs.first, rhs.second);
+    });
 
-        for (std::string_view word : query.plus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
+    std::vector<std::vector<Document>> results(raw_queries.size());
+    std::vector<QueryGroup> groups;
+    std::map<TermKey, std::vector<size_t>> term_groups; /*!<     */
+    for (const auto& [query_cost, query] : query_order) {
+        std::map<size_t, size_t> shared_costs;
+        for (const TermKey& term : query_terms[query]) {
+            const auto iterator = term_groups.find(term);
+            if (iterator == term_groups.end()) {
                 continue;
             }
-            if (word_to_document_freqs_.at(word).count(document_id)) {
-                matched_words.push_back(word);
+            for (const size_t group : iterator->second) {
+                if (groups[group].queries.size() < QUERY_GROUP_SIZE) {
+                    shared_costs[group] += index_.GetDocumentFreq(term.first);
+                }
+            }
+        }
+        size_t best_group = groups.size();
+        size_t best_cost = 0;
+        for (const auto& [group, shared_cost] : shared_costs) {
+            if (shared_cost > best_cost) {
+                best_group = group;
+                best_cost = shared_cost;
+            }
+        }
+        if (best_group == groups.size()) {
+            groups.emplace_back();
+        }
+
+        QueryGroup& group = groups[best_group];
+        group.queries.push_back(prepared_queries[query].get());
+        group.results.push_back(&results[query]);
+        for (const TermKey& term : query_terms[query]) {
+            if (group.terms.insert(term).second) {
+                group.cost += index_.GetDocumentFreq(term.first);
+                term_groups[term].push_back(best_group);
             }
         }
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const QueryGroup& lhs, const QueryGroup& rhs) {
+        return lhs.cost > rhs.cost;
+    });
+
+    RunParallel(groups.size(), [this, &groups](size_t i) {
+        FindTopDocumentsShared(groups[i].queries, groups[i].results);
+    });
+    return results;
+}
+
+/*! \fn SearchServer::PrepareQuery
+ *  \b   \b :   \n
+ *  \b   \b :      \n
+ *  \b  \b :  \n
+ *  \param[in] raw_query   \n
+ *  \return   \n
+ */
+PreparedQuery SearchServer::PrepareQuery(const std::string_view raw_query) const {
+    return *GetPreparedQuery(raw_query);
+}
+
+/*! \fn SearchServer::SetQueryCacheCapacity
+ *  \b   \b :   \n
+ *  \b   \b :      ,   \n
+ *  \b  \b :     \n
+ *  \param[in] capacity   \n
+ *  \return  \n
+ */
+void SearchServer::SetQueryCacheCapacity(size_t capacity) {
+    query_cache_ = std::make_shared<QueryCache>(capacity);
+}
+
+/*! \fn SearchServer::SetTermWeightTableEnabled
+ *  \b   \b :   \n
+ *  \b   \b :      .   IDF 
+ *                              \n
+ *  \b  \b :   ,       \n
+ *  \param[in] is_enabled   \n
+ *  \return  \n
+ */
+void SearchServer::SetTermWeightTableEnabled(bool is_enabled) {
+    is_term_weight_table_enabled_ = is_enabled;
+    query_cache_ = std::make_shared<QueryCache>(query_cache_->entries.GetCapacity());
+}
+
+/*! \fn SearchServer::SetResultCacheCapacity
+ *  \b   \b :   \n
+ *  \b   \b :       ,   
+ *                         \n
+ *  \b  \b :     \n
+ *  \param[in] capacity    \n
+ *  \return  \n
+ */
+void SearchServer::SetResultCacheCapacity(size_t capacity) {
+    result_cache_ = capacity > 0 ? std::make_shared<ResultCache>(capacity) : nullptr;
+}
+
+ResultCache::Stats SearchServer::GetResultCacheStats() const {
+    return result_cache_ ? result_cache_->GetStats() : ResultCache::Stats{};
+}
+
+/*! \fn SearchServer::SetThreadPool
+ *  \b   \b :   \n
+ *  \b   \b :        .
+ *                            ,   
+ *                           \n
+ *  \b  \b :    std::execution::par \n
+ *  \param[in] thread_pool   \n
+ *  \return  \n
+ */
+void SearchServer::SetThreadPool(std::shared_ptr<ThreadPool> thread_pool) {
+    thread_pool_ = std::move(thread_pool);
+}
 
-        return {matched_words, documents_.at(document_id).status};
+std::shared_ptr<ThreadPool> SearchServer::GetThreadPool() const {
+    return thread_pool_;
+}
+
+int SearchServer::GetDocumentCount() const {
+    if (is_mapped_) {
+        return static_cast<int>(mapped_documents_.sorted_document_ids.size());
     }
+    return static_cast<int>(document_to_internal_id_.size());
+}
+
+/*! \fn SearchServer::MatchDocument
+ *  \b   \b :   \n
+ *  \b   \b :     .    
+ *                                \n
+ *  \b  \b :   ,  std::out_of_range \n
+ *  \param[in] raw_query ""  \n
+ *  \param[in] document_id   \n
+ *  \return -     , ,    
+ *          -,    \n
+ */
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
+    const std::string& raw_query,
+    int document_id) const
+{
+    const int internal_id = FindInternalId(document_id);
+    if (internal_id == NO_INTERNAL_ID) {
+        throw std::out_of_range("There is no document with this document_id");
+    }
+
+    const Query query = ParseQuery(raw_query);
+    return { MatchQueryTerms(query, FindQueryTerms(query), internal_id), GetDocumentData(internal_id).status };
 }
 
 /*! \fn SearchServer::MatchDocument
@@ -112,7 +406,8 @@ std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDoc
 
 /*! \fn SearchServer::MatchDocument
  *  \b   \b :   \n
- *  \b   \b :   MatchDocument \n
+ *  \b   \b :   MatchDocument.    
+ *                          ,      \n
  *  \b  \b :  \n
  *  \param[in] raw_query ""  \n
  *  \param[in] document_id   \n
@@ -123,45 +418,42 @@ std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDoc
     const std::string& raw_query,
     int document_id) const
 {
-    if (0 == document_ids_.count(document_id)) {
-        throw std::out_of_range("There is no document with this document_id");
-    }
-
-    const Query query = ParseQuery(raw_query, false/* = sort_and_delete */);
-
-    bool minus_word_is = std::any_of(std::execution::par,
-        query.minus_words.begin(), query.minus_words.end(),
-        [this, document_id](std::string_view word) {
-            return word_to_document_freqs_.count(word) &&
-                word_to_document_freqs_.at(word).count(document_id);
-        });
-
-    if (minus_word_is) {
-        return {{}, documents_.at(document_id).status};
-    }
-    else {
-        std::vector<std::string_view> matched_words(query.plus_words.size());
+    return MatchDocument(raw_query, document_id);
+}
 
-        auto last_copy_it = std::copy_if(std::execution::par,
-            query.plus_words.begin(), query.plus_words.end(),
-            matched_words.begin(),
-            [this, document_id](std::string_view word) {
-                return word_to_document_freqs_.count(word) &&
-                    word_to_document_freqs_.at(word).count(document_id);
-            });
+/*! \fn SearchServer::MatchDocuments
+ *  \b   \b :   \n
+ *  \b   \b :      ,   
+ *                      .         \n
+ *  \b  \b :      ,  std::out_of_range \n
+ *  \param[in] raw_query ""  \n
+ *  \param[in] document_ids   \n
+ *  \return  MatchDocument   document_ids \n
+ */
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> SearchServer::MatchDocuments(
+    const std::string& raw_query,
+    const std::vector<int>& document_ids) const
+{
+    const Query query = ParseQuery(raw_query);
+    const QueryTerms query_terms = FindQueryTerms(query);
 
-        matched_words.erase(last_copy_it, matched_words.end());
-        std::sort(matched_words.begin(), matched_words.end());
-        auto last_unique_it = std::unique(matched_words.begin(), matched_words.end());
-        matched_words.erase(last_unique_it, matched_words.end());
-        return {matched_words, documents_.at(document_id).status};
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> result;
+    result.reserve(document_ids.size());
+    for (const int document_id : document_ids) {
+        const int internal_id = FindInternalId(document_id);
+        if (internal_id == NO_INTERNAL_ID) {
+            throw std::out_of_range("There is no document with this document_id");
+        }
+        result.emplace_back(MatchQueryTerms(query, query_terms, internal_id), GetDocumentData(internal_id).status);
     }
+    return result;
 }
 
 /*! \fn SearchServer::GetWordFrequencies
  *  \b   \b :   \n
- *  \b   \b :       \n
- *  \b  \b :  \n
+ *  \b   \b :      .  
+ *                                 \n
+ *  \b  \b :    \n
  *  \param[in] document_id   \n
  *  \return map,   - ,  -  \n
  *      document_id  ,    \n
@@ -170,9 +462,20 @@ const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int d
 {
     static const std::map<std::string_view, double> empty_result;
 
-    auto iterator = document_to_word_freqs_.find(document_id);
-    return iterator != document_to_word_freqs_.end() ? document_to_word_freqs_.at(document_id) :
-        empty_result;
+    const int internal_id = FindInternalId(document_id);
+    if (internal_id == NO_INTERNAL_ID) {
+        return empty_result;
+    }
+    std::lock_guard guard(word_freqs_cache_.mutex);
+    const auto [iterator, inserted] = word_freqs_cache_.word_freqs.try_emplace(internal_id);
+    if (inserted) {
+        const Span<int> term_ids = GetDocumentTermIds(internal_id);
+        const Span<double> term_freqs = GetDocumentTermFreqs(internal_id);
+        for (size_t i = 0; i < term_ids.size(); ++i) {
+            iterator->second.emplace(index_.GetTerm(term_ids[i]), term_freqs[i]);
+        }
+    }
+    return iterator->second;
 }
 
 /*! \fn SearchServer::RemoveDocument
@@ -183,16 +486,7 @@ const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int d
  *  \return  \n
  */
 void SearchServer::RemoveDocument(int document_id) {
-    if (0 == document_ids_.count(document_id)) {
-        return;
-    }
-
-    for (const auto& [word, frequency] : document_to_word_freqs_.at(document_id)) {
-        word_to_document_freqs_.at(word).erase(document_id);
-    }
-    document_to_word_freqs_.erase(document_id);
-    documents_.erase(document_id);
-    document_ids_.erase(document_id);
+    RemoveDocuments({ document_id });
 }
 
 /*! \fn SearchServer::RemoveDocument
@@ -209,46 +503,331 @@ void SearchServer::RemoveDocument(const std::execution::sequenced_policy&, int d
 
 /*! \fn SearchServer::RemoveDocument
  *  \b   \b :   \n
- *  \b   \b :   RemoveDocument \n
+ *  \b   \b :   RemoveDocument.   
+ *                      ,    , . RemoveDocuments \n
  *  \b  \b :  \n
  *  \param[in] document_id   \n
  *  \return  \n
  */
 void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int document_id) {
-    if (0 == document_ids_.count(document_id)) {
-        return ;
+    RemoveDocuments({ document_id });
+}
+
+/*! \fn SearchServer::RemoveDocuments
+ *  \b   \b :   \n
+ *  \b   \b :   .     
+ *                         .    
+ *                         ,    ,
+ *                        ,    
+ *                         \n
+ *  \b  \b :    \n
+ *  \param[in] document_ids   \n
+ *  \return  \n
+ */
+void SearchServer::RemoveDocuments(const std::vector<int>& document_ids) {
+    Detach();
+
+    bool is_removed = false;
+    for (const int document_id : document_ids) {
+        const int* internal_id = document_to_internal_id_.Find(document_id);
+        if (internal_id == nullptr) {
+            continue;
+        }
+
+        index_.RemoveDocument(*internal_id, document_terms_[*internal_id]->term_ids);
+        document_terms_.GetMutable(*internal_id).reset();
+        word_freqs_cache_.word_freqs.erase(*internal_id);
+        ReleaseDocumentText(*internal_id);
+        document_to_internal_id_.Erase(document_id);
+        is_removed = true;
+    }
+    if (!is_removed) {
+        return;
     }
 
-    {
-        std::vector<std::string_view> words(document_to_word_freqs_.at(document_id).size());
-        std::transform(std::execution::par,
-            document_to_word_freqs_.at(document_id).cbegin(),
-            document_to_word_freqs_.at(document_id).cend(),
-            words.begin(),
-            [](const auto &value) {return value.first;});
-        std::for_each(std::execution::par,
-            words.cbegin(), words.cend(),
-            [this, document_id](const auto &word) {word_to_document_freqs_.at(word).erase(document_id);});
+    if (index_.NeedsPurge()) {
+        index_.PurgeDeleted([this](size_t count, const auto& function) {
+            RunParallel(count, function);
+        });
     }
+    UpdateGeneration();
+}
+
+/*! \fn SearchServer::MergeIndexSegments
+ *  \b   \b :   \n
+ *  \b   \b :        .
+ *                            \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void SearchServer::MergeIndexSegments() {
+    index_.Flush();
+    index_.WaitForMerges();
+}
 
-    {
-        auto iterator = document_to_word_freqs_.find(document_id);
-        document_to_word_freqs_.erase(iterator);
+/*! \fn SearchServer::GetIndexMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :  ,    \n
+ *  \b  \b :  \n
+ *  \return    \n
+ */
+InvertedIndex::MemoryStats SearchServer::GetIndexMemoryStats() const {
+    return index_.GetMemoryStats();
+}
+
+/*! \fn SearchServer::GetTextMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :  ,    \n
+ *  \b  \b :       \n
+ *  \return    \n
+ */
+TextArena::MemoryStats SearchServer::GetTextMemoryStats() const {
+    TextArena::MemoryStats stats = document_chars_.GetMemoryStats();
+    stats.reserved_bytes += document_texts_.GetMemoryBytes();
+    return stats;
+}
+
+/*! \fn SearchServer::Save
+ *  \b   \b :   \n
+ *  \b   \b :     : -, ,  ,
+ *                      ,     .  
+ *                       ,     \n
+ *  \b  \b :          
+ *                         \n
+ *  \param[in] path    \n
+ *  \return  \n
+ */
+void SearchServer::Save(const std::string& path) const {
+    IndexFileWriter writer;
+
+    std::vector<char> stop_word_chars;
+    std::vector<uint64_t> stop_word_offsets(1, 0);
+    for (const std::string& stop_word : stop_words_) {
+        stop_word_chars.insert(stop_word_chars.end(), stop_word.begin(), stop_word.end());
+        stop_word_offsets.push_back(stop_word_chars.size());
     }
+    writer.AddSection(IndexSection::STOP_WORD_CHARS, Span<char>(stop_word_chars));
+    writer.AddSection(IndexSection::STOP_WORD_OFFSETS, Span<uint64_t>(stop_word_offsets));
+
+    const int internal_document_count = GetInternalDocumentCount();
+    std::vector<int> new_internal_ids(internal_document_count, NO_INTERNAL_ID);
+    std::vector<DocumentData> documents;
+    std::vector<std::pair<int, int>> document_to_internal_id;
+    std::vector<char> text_chars;
+    std::vector<uint64_t> text_offsets(1, 0);
+    std::vector<uint64_t> forward_offsets(1, 0);
+    std::vector<int> forward_term_ids;
+    std::vector<double> forward_term_freqs;
+    for (int internal_id = 0; internal_id < internal_document_count; ++internal_id) {
+        const DocumentData& document_data = GetDocumentData(internal_id);
+        if (FindInternalId(document_data.id) != internal_id) {
+            continue;
+        }
+        new_internal_ids[internal_id] = static_cast<int>(documents.size());
+        document_to_internal_id.emplace_back(document_data.id, new_internal_ids[internal_id]);
+        documents.push_back(document_data);
 
-    {
-        auto iterator = documents_.find(document_id);
-        documents_.erase(iterator);
+        const std::string_view text = GetDocumentText(internal_id);
+        text_chars.insert(text_chars.end(), text.begin(), text.end());
+        text_offsets.push_back(text_chars.size());
+
+        const Span<int> term_ids = GetDocumentTermIds(internal_id);
+        const Span<double> term_freqs = GetDocumentTermFreqs(internal_id);
+        forward_term_ids.insert(forward_term_ids.end(), term_ids.begin(), term_ids.end());
+        forward_term_freqs.insert(forward_term_freqs.end(), term_freqs.begin(), term_freqs.end());
+        forward_offsets.push_back(forward_term_ids.size());
     }
 
-    {
-        auto iterator = document_ids_.find(document_id);
-        document_ids_.erase(iterator);
+    std::sort(document_to_internal_id.begin(), document_to_internal_id.end());
+    std::vector<int> sorted_document_ids;
+    std::vector<int> sorted_internal_ids;
+    for (const auto& [document_id, internal_id] : document_to_internal_id) {
+        sorted_document_ids.push_back(document_id);
+        sorted_internal_ids.push_back(internal_id);
     }
+
+    index_.Save(writer, new_internal_ids, static_cast<int>(documents.size()));
+    writer.AddSection(IndexSection::DOCUMENTS, Span<DocumentData>(documents));
+    writer.AddSection(IndexSection::SORTED_DOCUMENT_IDS, Span<int>(sorted_document_ids));
+    writer.AddSection(IndexSection::SORTED_INTERNAL_IDS, Span<int>(sorted_internal_ids));
+    writer.AddSection(IndexSection::TEXT_CHARS, Span<char>(text_chars));
+    writer.AddSection(IndexSection::TEXT_OFFSETS, Span<uint64_t>(text_offsets));
+    writer.AddSection(IndexSection::FORWARD_OFFSETS, Span<uint64_t>(forward_offsets));
+    writer.AddSection(IndexSection::FORWARD_TERM_IDS, Span<int>(forward_term_ids));
+    writer.AddSection(IndexSection::FORWARD_TERM_FREQS, Span<double>(forward_term_freqs));
+    writer.Write(path);
+}
+
+std::set<std::string, std::less<>> SearchServer::ReadStopWords(const IndexFileReader& reader) {
+    const Span<char> chars = reader.GetSection<char>(IndexSection::STOP_WORD_CHARS);
+    const Span<uint64_t> offsets = reader.GetSection<uint64_t>(IndexSection::STOP_WORD_OFFSETS);
+    if (!AreValidOffsets(offsets, chars.size())) {
+        throw std::invalid_argument("Index file stop words are corrupted");
+    }
+
+    std::set<std::string, std::less<>> stop_words;
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+        stop_words.emplace(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    return stop_words;
+}
+
+/*! \fn SearchServer::Detach
+ *  \b   \b :   \n
+ *  \b   \b :         
+ *                         .       \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void SearchServer::Detach() {
+    if (!is_mapped_) {
+        return;
+    }
+
+    const MappedDocuments& mapped = mapped_documents_;
+    std::vector<std::pair<int, int>> document_to_internal_id;
+    document_to_internal_id.reserve(mapped.sorted_document_ids.size());
+    for (size_t i = 0; i < mapped.sorted_document_ids.size(); ++i) {
+        document_to_internal_id.emplace_back(mapped.sorted_document_ids[i], mapped.sorted_internal_ids[i]);
+    }
+    document_to_internal_id_ = ChunkedMap<int, int>(document_to_internal_id);
+    /*       */
+    for (size_t internal_id = 0; internal_id < mapped.documents.size(); ++internal_id) {
+        const Span<int> term_ids = GetDocumentTermIds(static_cast<int>(internal_id));
+        const Span<double> term_freqs = GetDocumentTermFreqs(static_cast<int>(internal_id));
+        documents_.push_back(mapped.documents[internal_id]);
+        document_terms_.push_back(std::make_shared<const DocumentTerms>(DocumentTerms{
+            std::vector<int>(term_ids.begin(), term_ids.end()),
+            std::vector<double>(term_freqs.begin(), term_freqs.end()) }));
+        document_texts_.push_back(GetDocumentText(static_cast<int>(internal_id)));
+    }
+    is_mapped_ = false;
+}
+
+uint64_t SearchServer::NextGeneration() {
+    static std::atomic<uint64_t> last_generation{ 0 };
+    return ++last_generation;
+}
+
+/*! \fn SearchServer::UpdateGeneration
+ *  \b   \b :   \n
+ *  \b   \b :       . 
+ *                             , 
+ *                        ,      \n
+ *  \b  \b :  \n
+ *  \return  \n
+ */
+void SearchServer::UpdateGeneration() {
+    generation_ = NextGeneration();
+    query_cache_ = std::make_shared<QueryCache>(query_cache_->entries.GetCapacity());
+    term_weights_.Invalidate(index_.GetTermCount());
+}
+
+int SearchServer::FindInternalId(int document_id) const {
+    if (is_mapped_) {
+        const Span<int>& sorted_document_ids = mapped_documents_.sorted_document_ids;
+        const auto iterator = std::lower_bound(sorted_document_ids.begin(), sorted_document_ids.end(), document_id);
+        return iterator != sorted_document_ids.end() && *iterator == document_id ?
+            mapped_documents_.sorted_internal_ids[iterator - sorted_document_ids.begin()] : NO_INTERNAL_ID;
+    }
+    const int* internal_id = document_to_internal_id_.Find(document_id);
+    return internal_id != nullptr ? *internal_id : NO_INTERNAL_ID;
+}
+
+std::string_view SearchServer::GetDocumentText(int internal_id) const {
+    if (!is_mapped_) {
+        return document_texts_[internal_id];
+    }
+    const Span<uint64_t>& text_offsets = mapped_documents_.text_offsets;
+    return { mapped_documents_.text_chars.data() + text_offsets[internal_id],
+        static_cast<size_t>(text_offsets[internal_id + 1] - text_offsets[internal_id]) };
+}
+
+/*     ,       */
+Span<int> SearchServer::GetDocumentTermIds(int internal_id) const {
+    if (!is_mapped_) {
+        const auto& document_terms = document_terms_[internal_id];
+        return document_terms ? Span<int>(document_terms->term_ids) : Span<int>();
+    }
+    const MappedDocuments& mapped = mapped_documents_;
+    return { mapped.forward_term_ids.data() + mapped.forward_offsets[internal_id],
+        static_cast<size_t>(mapped.forward_offsets[internal_id + 1] - mapped.forward_offsets[internal_id]) };
+}
+
+Span<double> SearchServer::GetDocumentTermFreqs(int internal_id) const {
+    if (!is_mapped_) {
+        const auto& document_terms = document_terms_[internal_id];
+        return document_terms ? Span<double>(document_terms->term_freqs) : Span<double>();
+    }
+    const MappedDocuments& mapped = mapped_documents_;
+    return { mapped.forward_term_freqs.data() + mapped.forward_offsets[internal_id],
+        static_cast<size_t>(mapped.forward_offsets[internal_id + 1] - mapped.forward_offsets[internal_id]) };
+}
+
+/*! \fn SearchServer::MakeDocumentTerms
+ *  \b   \b :   \n
+ *  \b   \b :    :   
+ *                      ,      \n
+ *  \b  \b :        
+ *                        , . ComputeTermFreq \n
+ *  \param[in] term_counts      \n
+ *  \param[in] word_count      \n
+ *  \return    \n
+ */
+std::shared_ptr<const SearchServer::DocumentTerms> SearchServer::MakeDocumentTerms(
+    std::vector<std::pair<int, int>> term_counts,
+    int word_count)
+{
+    std::sort(term_counts.begin(), term_counts.end());
+    const double inv_word_count = 1.0 / word_count;
+    auto result = std::make_shared<DocumentTerms>();
+    for (size_t first = 0; first < term_counts.size();) {
+        int count = 0;
+        size_t last = first;
+        for (; last < term_counts.size() && term_counts[last].first == term_counts[first].first; ++last) {
+            count += term_counts[last].second;
+        }
+        result->term_ids.push_back(term_counts[first].first);
+        result->term_freqs.push_back(ComputeTermFreq(count, inv_word_count));
+        first = last;
+    }
+    return result;
+}
+
+/*! \fn SearchServer::ReleaseDocumentText
+ *  \b   \b :   \n
+ *  \b   \b :    .   
+ *                         ,     
+ *                      ,         \n
+ *  \b  \b :       \n
+ *  \param[in] internal_id    \n
+ *  \return  \n
+ */
+void SearchServer::ReleaseDocumentText(int internal_id) {
+    document_chars_.Release(document_texts_[internal_id]);
+    document_texts_.GetMutable(internal_id) = {};
+    if (!document_chars_.NeedsCompaction()) {
+        return;
+    }
+
+    TextArena document_chars;
+    for (size_t i = 0; i < document_texts_.size(); ++i) {
+        if (document_chars_.Contains(document_texts_[i])) {
+            document_texts_.GetMutable(i) = document_chars.Add(document_texts_[i]);
+        }
+    }
+    document_chars_ = std::move(document_chars);
+}
+
+size_t SearchServer::GetThreadCount() const {
+    if (thread_pool_) {
+        return std::max<size_t>(1, thread_pool_->GetWorkerCount());
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
 }
 
 bool SearchServer::IsStopWord(std::string_view word) const {
-    return stop_words_.count(word) > 0;
+    return stop_word_set_.Contains(word);
 }
 
 bool SearchServer::IsValidWord(std::string_view word) {
@@ -260,8 +839,10 @@ bool SearchServer::IsValidWord(std::string_view word) {
 std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text) const {
     std::vector<std::string_view> words;
 
-    for (const auto &word : SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
+    WordTokenizer tokenizer(text);
+    while (tokenizer.Next()) {
+        const std::string_view word = tokenizer.GetWord();
+        if (!tokenizer.IsValidWord()) {
             throw std::invalid_argument("Word " + std::string(word) + " is invalid");
         }
         if (!IsStopWord(word)) {
@@ -279,7 +860,89 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     return rating_sum / static_cast<int>(ratings.size());
 }
 
-SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {
+void SearchServer::CheckNewDocumentIds(const std::vector<RawDocument>& documents) const {
+    std::set<int> document_ids;
+
+    for (const auto& document : documents) {
+        if ((document.id < 0) || (document_to_internal_id_.Find(document.id) != nullptr) ||
+            !document_ids.insert(document.id).second) {
+            throw std::invalid_argument("Invalid document_id");
+        }
+    }
+}
+
+/*! \fn SearchServer::PrepareDocument
+ *  \b   \b :   \n
+ *  \b   \b :           \n
+ *  \b  \b :   .     ,
+ *                              \n
+ *  \param[in] document  \n
+ *  \return   \n
+ */
+SearchServer::PreparedDocument SearchServer::PrepareDocument(const RawDocument& document) const {
+    PreparedDocument result;
+
+    try {
+        const auto words = SplitIntoWordsNoStop(document.text);
+        result.word_count = static_cast<int>(words.size());
+        std::map<std::string_view, size_t> word_positions;
+        for (const auto& word : words) {
+            const auto [iterator, inserted] = word_positions.emplace(word, result.word_counts.size());
+            if (inserted) {
+                result.word_counts.emplace_back(word, 0);
+            }
+            ++result.word_counts[iterator->second].second;
+        }
+    }
+    catch (...) {
+        result.error = std::current_exception();
+    }
+    return result;
+}
+
+/*! \fn SearchServer::AddPreparedDocuments
+ *  \b   \b :   \n
+ *  \b   \b :   .       
+ *                      ,      AddDocument, 
+ *                         \n
+ *  \b  \b :       ,   
+ *                          \n
+ *  \param[in] documents  \n
+ *  \param[in,out] prepared_documents  ,     \n
+ *  \return  \n
+ */
+void SearchServer::AddPreparedDocuments(const std::vector<RawDocument>& documents,
+                                        std::vector<PreparedDocument>& prepared_documents)
+{
+    for (const auto& prepared_document : prepared_documents) {
+        if (prepared_document.error) {
+            std::rethrow_exception(prepared_document.error);
+        }
+    }
+
+    const int first_internal_id = static_cast<int>(documents_.size());
+    std::vector<std::vector<std::pair<int, int>>> document_term_counts(documents.size());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        PreparedDocument& prepared_document = prepared_documents[i];
+        document_term_counts[i].reserve(prepared_document.word_counts.size());
+        for (const auto& [word, count] : prepared_document.word_counts) {
+            document_term_counts[i].emplace_back(index_.AddTerm(word), count);
+        }
+        document_texts_.push_back(document_chars_.Add(documents[i].text));
+    }
+    index_.AddSegment(first_internal_id, document_term_counts);
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const RawDocument& document = documents[i];
+        document_terms_.push_back(MakeDocumentTerms(std::move(document_term_counts[i]),
+            prepared_documents[i].word_count));
+        documents_.push_back({document.id, ComputeAverageRating(document.ratings), document.status});
+        document_to_internal_id_.Insert(document.id, first_internal_id + static_cast<int>(i));
+    }
+    UpdateGeneration();
+}
+
+SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text, bool is_valid_word) const {
     if (text.empty()) {
         throw std::invalid_argument("Query word is empty");
     }
@@ -289,7 +952,7 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
         is_minus = true;
         text.remove_prefix(1);
     }
-    if (text.empty() || text[0] == '-' || !IsValidWord(text)) {
+    if (text.empty() || text[0] == '-' || !is_valid_word) {
         throw std::invalid_argument("Query word " + std::string(text) + " is invalid");
     }
 
@@ -301,8 +964,9 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text,
 {
     Query result;
 
-    for (std::string_view word : SplitIntoWords(text)) {
-        const QueryWord query_word = ParseQueryWord(word);
+    WordTokenizer tokenizer(text);
+    while (tokenizer.Next()) {
+        const QueryWord query_word = ParseQueryWord(tokenizer.GetWord(), tokenizer.IsValidWord());
         if (!query_word.is_stop) {
             if (query_word.is_minus) {
                 result.minus_words.push_back(query_word.data);
@@ -325,6 +989,294 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view text,
     return result;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+/*! \fn SearchServer::GetPreparedQuery
+ *  \b   \b :   \n
+ *  \b   \b :          ,
+ *                           .    
+ *                       ,            \n
+ *  \b  \b :   .        ,
+ *                            \n
+ *  \param[in] raw_query   \n
+ *  \return   \n
+ */
+std::shared_ptr<const PreparedQuery> SearchServer::GetPreparedQuery(std::string_view raw_query) const {
+    const std::shared_ptr<QueryCache> cache = query_cache_;
+    const bool is_cached = cache->entries.GetCapacity() > 0;
+    std::string raw_text;
+    if (is_cached) {
+        raw_text = raw_query;
+        std::lock_guard guard(cache->mutex);
+        const auto* prepared_query = cache->raw_entries.Find(raw_text);
+        if (prepared_query != nullptr && (*prepared_query)->generation_ == generation_) {
+            return *prepared_query;
+        }
+    }
+
+    const Query query = ParseQuery(raw_query);
+
+    std::string text;
+    for (std::string_view word : query.plus_words) {
+        text.append(text.empty() ? "" : " ").append(word);
+    }
+    for (std::string_view word : query.minus_words) {
+        text.append(text.empty() ? "-" : " -").append(word);
+    }
+
+    if (is_cached) {
+        std::lock_guard guard(cache->mutex);
+        const auto* prepared_query = cache->entries.Find(text);
+        if (prepared_query != nullptr && (*prepared_query)->generation_ == generation_) {
+            std::shared_ptr<const PreparedQuery> result = *prepared_query;
+            cache->raw_entries.Put(raw_text, result);
+            return result;
+        }
+    }
+
+    auto prepared_query = std::make_shared<PreparedQuery>();
+    for (std::string_view word : query.plus_words) {
+        const int term_id = index_.FindTerm(word);
+        if (term_id != InvertedIndex::NO_TERM && index_.GetDocumentFreq(term_id) > 0) {
+            const TermWeightTable::TermWeight weight = GetTermWeight(term_id);
+            prepared_query->plus_terms_.push_back({ term_id, weight.inverse_document_freq,
+                weight.max_term_freq, weight.max_impact });
+        }
+    }
+    for (std::string_view word : query.minus_words) {
+        const int term_id = index_.FindTerm(word);
+        if (term_id != InvertedIndex::NO_TERM) {
+            prepared_query->minus_term_ids_.push_back(term_id);
+        }
+    }
+    prepared_query->generation_ = generation_;
+    prepared_query->text_ = std::move(text);
+
+    if (is_cached) {
+        std::lock_guard guard(cache->mutex);
+        cache->entries.Put(prepared_query->text_, prepared_query);
+        cache->raw_entries.Put(raw_text, prepared_query);
+    }
+    return prepared_query;
+}
+
+/*     ,      
+    ,           */
+std::string SearchServer::MakeResultCacheKey(const PreparedQuery& prepared_query,
+                                             DocumentStatus status,
+                                             const SearchOptions& options,
+                                             const std::string& ranking_key) const
+{
+    std::string key = prepared_query.text_;
+    key.push_back('\0');
+    key += std::to_string(static_cast<int>(status));
+    key.push_back(' ');
+    key += std::to_string(options.max_result_count);
+    key.push_back(' ');
+    key += std::to_string(static_cast<int>(options.scoring_mode));
+    key.push_back(' ');
+    key += ranking_key;
+    key.push_back(' ');
+    key += std::to_string(generation_);
+    return key;
+}
+
+/*! \fn SearchServer::GetCollectionStats
+ *  \b   \b :   \n
+ *  \b   \b :     .  
+ *                             \n
+ *  \b  \b :  \n
+ *  \return       \n
+ */
+CollectionStats SearchServer::GetCollectionStats() const {
+    CollectionStats stats;
+    stats.document_count = GetDocumentCount();
+    if (stats.document_count > 0) {
+        stats.average_document_length = static_cast<double>(index_.GetTotalDocumentLength()) / stats.document_count;
+    }
+    return stats;
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(int term_id) const {
+    return log(GetDocumentCount() * 1.0 / index_.GetDocumentFreq(term_id));
+}
+
+/*! \fn SearchServer::ComputeTermWeight
+ *  \b   \b :   \n
+ *  \b   \b :  IDF       :
+ *                      IDF,         \n
+ *  \b  \b :    .   
+ *                        ,     \n
+ *  \param[in] term_id   \n
+ *  \return   \n
+ */
+TermWeightTable::TermWeight SearchServer::ComputeTermWeight(int term_id) const {
+    TermWeightTable::TermWeight weight;
+    weight.inverse_document_freq = ComputeWordInverseDocumentFreq(term_id);
+    for (size_t segment = 0; segment < index_.GetSegmentCount(); ++segment) {
+        weight.max_term_freq = std::max(weight.max_term_freq, index_.GetPostings(segment, term_id).max_term_freq);
+    }
+    weight.max_impact = weight.max_term_freq * weight.inverse_document_freq;
+    return weight;
+}
+
+TermWeightTable::TermWeight SearchServer::GetTermWeight(int term_id) const {
+    if (!is_term_weight_table_enabled_) {
+        return ComputeTermWeight(term_id);
+    }
+    return term_weights_.Get(term_id, [this](int id) {
+        return ComputeTermWeight(id);
+    });
+}
+
+/*! \fn SearchServer::FindTopDocumentsShared
+ *  \b   \b :   \n
+ *  \b   \b :          
+ *                        .      
+ *                            \n
+ *  \b  \b :    ,  -   , 
+ *                           ,    FindAllDocuments \n
+ *  \param[in] queries     \n
+ *  \param[out] results  ,      \n
+ *  \return  \n
+ */
+void SearchServer::FindTopDocumentsShared(const std::vector<const PreparedQuery*>& queries,
+                                          std::vector<std::vector<Document>*>& results) const
+{
+    struct TermUse {
+        int term_id;
+        size_t query;
+        double inverse_document_freq;
+    };
+
+    const int document_count = GetInternalDocumentCount();
+    BatchScoringWorkspace::Lease workspace(document_count, queries.size());
+    std::vector<TermUse> minus_terms;
+    std::vector<TermUse> plus_terms;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        for (const int term_id : queries[i]->minus_term_ids_) {
+            minus_terms.push_back({ term_id, i, 0.0 });
+        }
+        for (const PreparedQuery::Term& term : queries[i]->plus_terms_) {
+            plus_terms.push_back({ term.term_id, i, term.inverse_document_freq });
+        }
+    }
+    std::sort(minus_terms.begin(), minus_terms.end(), [](const TermUse& lhs, const TermUse& rhs) {
+        return std::pair(lhs.term_id, lhs.query) < std::pair(rhs.term_id, rhs.query);
+    });
+    std::sort(plus_terms.begin(), plus_terms.end(), [this](const TermUse& lhs, const TermUse& rhs) {
+        return std::pair(index_.GetTerm(lhs.term_id), lhs.query) < std::pair(index_.GetTerm(rhs.term_id), rhs.query);
+    });
+
+    for (auto first = minus_terms.begin(); first != minus_terms.end();) {
+        const auto last = std::find_if(first, minus_terms.end(), [first](const TermUse& use) {
+            return use.term_id != first->term_id;
+        });
+        ForEachPosting(first->term_id, 0, document_count,
+            [&workspace, first, last](const InvertedIndex::PostingIterator& posting) {
+                for (auto use = first; use != last; ++use) {
+                    workspace->Veto(posting.GetDocumentId(), use->query);
+                }
+            });
+        first = last;
+    }
+
+    auto document_filter = [this](int internal_id) {
+        return !index_.IsDeleted(internal_id) && GetDocumentData(internal_id).status == DocumentStatus::ACTUAL;
+    };
+    for (auto first = plus_terms.begin(); first != plus_terms.end();) {
+        const auto last = std::find_if(first, plus_terms.end(), [first](const TermUse& use) {
+            return use.term_id != first->term_id;
+        });
+        ForEachPosting(first->term_id, 0, document_count,
+            [&workspace, &document_filter, first, last](const InvertedIndex::PostingIterator& posting) {
+                const int internal_id = posting.GetDocumentId();
+                const double term_freq = posting.GetTermFreq();
+                for (auto use = first; use != last; ++use) {
+                    workspace->Add(internal_id, use->query, term_freq * use->inverse_document_freq,
+                        document_filter);
+                }
+            });
+        first = last;
+    }
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        TopDocuments top_documents(MAX_RESULT_DOCUMENT_COUNT);
+        workspace->ForEachScored(i, [this, &top_documents](int internal_id, double relevance) {
+            const auto& document_data = GetDocumentData(internal_id);
+            top_documents.Add({ document_data.id, relevance, document_data.rating });
+        });
+        *results[i] = top_documents.Extract();
+    }
+}
+
+/*     value:   first ,       */
+const int* SearchServer::GallopLowerBound(const int* first, const int* last, int value) {
+    size_t step = 1;
+    while (static_cast<size_t>(last - first) > step && first[step] < value) {
+        first += step;
+        step *= 2;
+    }
+    return std::lower_bound(first, first + std::min(step + 1, static_cast<size_t>(last - first)), value);
+}
+
+SearchServer::QueryTerms SearchServer::FindQueryTerms(const Query& query) const {
+    QueryTerms result;
+    for (size_t i = 0; i < query.plus_words.size(); ++i) {
+        const int term_id = index_.FindTerm(query.plus_words[i]);
+        if (term_id != InvertedIndex::NO_TERM) {
+            result.plus_terms.emplace_back(term_id, i);
+        }
+    }
+    for (std::string_view word : query.minus_words) {
+        const int term_id = index_.FindTerm(word);
+        if (term_id != InvertedIndex::NO_TERM) {
+            result.minus_term_ids.push_back(term_id);
+        }
+    }
+    std::sort(result.plus_terms.begin(), result.plus_terms.end());
+    std::sort(result.minus_term_ids.begin(), result.minus_term_ids.end());
+    return result;
+}
+
+/*! \fn SearchServer::MatchQueryTerms
+ *  \b   \b :   \n
+ *  \b   \b :       .  
+ *                        ,     
+ *                         \n
+ *  \b  \b :  \n
+ *  \param[in] query   \n
+ *  \param[in] query_terms     \n
+ *  \param[in] internal_id    \n
+ *  \return -     query.plus_words    - \n
+ */
+std::vector<std::string_view> SearchServer::MatchQueryTerms(const Query& query,
+                                                            const QueryTerms& query_terms,
+                                                            int internal_id) const
+{
+    const Span<int> term_ids = GetDocumentTermIds(internal_id);
+    const int* const last = term_ids.end();
+
+    const int* position = term_ids.begin();
+    for (const int term_id : query_terms.minus_term_ids) {
+        position = GallopLowerBound(position, last, term_id);
+        if (position != last && *position == term_id) {
+            return {};
+        }
+    }
+
+    std::vector<char> is_matched(query.plus_words.size());
+    position = term_ids.begin();
+    for (const auto& [term_id, word_index] : query_terms.plus_terms) {
+        position = GallopLowerBound(position, last, term_id);
+        if (position != last && *position == term_id) {
+            is_matched[word_index] = true;
+        }
+    }
+
+    std::vector<std::string_view> matched_words;
+    for (size_t i = 0; i < query.plus_words.size(); ++i) {
+        if (is_matched[i]) {
+            matched_words.push_back(query.plus_words[i]);
+        }
+    }
+    return matched_words;
 }
@@ -1,34 +1,103 @@
 #pragma once
 
 #include <algorithm>
+#include <numeric>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <tuple>
 #include <map>
 #include <stdexcept>
+#include <exception>
 #include <execution>
 #include <mutex>
 #include <future>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <atomic>
 
+#include "cancellation.h"
+#include "chunked_map.h"
+#include "chunked_vector.h"
 #include "document.h"
 #include "string_processing.h"
-#include "concurrent_map.h"
+#include "inverted_index.h"
+#include "lru_cache.h"
+#include "ranking.h"
+#include "result_cache.h"
+#include "scoring_workspace.h"
+#include "stop_words.h"
+#include "term_weight_table.h"
+#include "text_arena.h"
+#include "thread_pool.h"
+#include "top_documents.h"
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
+const size_t QUERY_CACHE_CAPACITY = 1024; /*!<       */
+
+enum class ScoringMode {
+    EXHAUSTIVE, /*!<        */
+    WAND,       /*!<  ,       */
+};
+
+struct RawDocument {
+    int id = 0;                                      /*!<   */
+    std::string_view text;                           /*!<   */
+    DocumentStatus status = DocumentStatus::ACTUAL;  /*!<   */
+    std::vector<int> ratings;                        /*!<   */
+};
+
+struct SearchOptions {
+    size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT; /*!<     */
+    ScoringMode scoring_mode = ScoringMode::EXHAUSTIVE;  /*!<     */
+    CancellationToken cancellation;                      /*!<  ,     */
+};
+
+/*  :    ,   .    
+   ,   ,       */
+class PreparedQuery {
+public:
+    const std::string& GetText() const;
+
+private:
+    friend class SearchServer;
+
+    struct Term {
+        int term_id;
+        double inverse_document_freq;
+        double max_term_freq; /*!<      */
+        double max_impact;    /*!<       TF-IDF */
+    };
+
+    std::string text_;                 /*!<  : -  -   */
+    std::vector<Term> plus_terms_;     /*!< -,    */
+    std::vector<int> minus_term_ids_;  /*!< -,    */
+    uint64_t generation_ = 0;          /*!<  ,     */
+};
 
 class SearchServer {
 public:
     template <typename StringContainer>
     explicit SearchServer(const StringContainer& stop_words);
+    template <size_t N>
+    explicit SearchServer(const StaticStopWords<N>& stop_words);
     explicit SearchServer(const std::string& stop_words_text);
     explicit SearchServer(const std::string_view stop_words_text);
-    std::set<int>::iterator begin();
-    std::set<int>::iterator end();
+    explicit SearchServer(std::shared_ptr<const MappedFile> index_file, bool verify_checksums = false);
+    using DocumentIdIterator = ChunkedMap<int, int>::KeyIterator;
+
+    DocumentIdIterator begin();
+    DocumentIdIterator end();
     void AddDocument(int document_id,
                      const std::string_view document,
                      DocumentStatus status,
                      const std::vector<int>& ratings);
+    void AddDocuments(const std::vector<RawDocument>& documents);
+    void AddDocuments(const std::execution::sequenced_policy&,
+                      const std::vector<RawDocument>& documents);
+    void AddDocuments(const std::execution::parallel_policy&,
+                      const std::vector<RawDocument>& documents);
     template <typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
                                            const std::string_view raw_query,
@@ -43,9 +112,64 @@ public:
     std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
                                            const std::string_view raw_query,
                                            DocumentPredicate document_predicate) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const std::string_view raw_query,
+                                           DocumentStatus status,
+                                           const SearchOptions& options) const;
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const std::string_view raw_query,
+                                           DocumentPredicate document_predicate,
+                                           const SearchOptions& options) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const PreparedQuery& prepared_query) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const PreparedQuery& prepared_query,
+                                           DocumentStatus status,
+                                           const SearchOptions& options) const;
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const PreparedQuery& prepared_query,
+                                           DocumentPredicate document_predicate,
+                                           const SearchOptions& options) const;
+    template <typename ExecutionPolicy, typename Ranking>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const std::string_view raw_query,
+                                           DocumentStatus status,
+                                           const SearchOptions& options,
+                                           const Ranking& ranking) const;
+    template <typename ExecutionPolicy, typename DocumentPredicate, typename Ranking>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const std::string_view raw_query,
+                                           DocumentPredicate document_predicate,
+                                           const SearchOptions& options,
+                                           const Ranking& ranking) const;
+    template <typename ExecutionPolicy, typename Ranking>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const PreparedQuery& prepared_query,
+                                           DocumentStatus status,
+                                           const SearchOptions& options,
+                                           const Ranking& ranking) const;
+    template <typename ExecutionPolicy, typename DocumentPredicate, typename Ranking>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy,
+                                           const PreparedQuery& prepared_query,
+                                           DocumentPredicate document_predicate,
+                                           const SearchOptions& options,
+                                           const Ranking& ranking) const;
     std::vector<Document> FindTopDocuments(const std::string_view raw_query,
                                            DocumentStatus status) const;
     std::vector<Document> FindTopDocuments(const std::string_view raw_query) const;
+    std::vector<std::vector<Document>> FindTopDocumentsBatch(const std::vector<std::string>& raw_queries) const;
+    PreparedQuery PrepareQuery(const std::string_view raw_query) const;
+    void SetQueryCacheCapacity(size_t capacity);
+    void SetTermWeightTableEnabled(bool is_enabled);
+    void SetResultCacheCapacity(size_t capacity);
+    ResultCache::Stats GetResultCacheStats() const;
+    void SetThreadPool(std::shared_ptr<ThreadPool> thread_pool);
+    std::shared_ptr<ThreadPool> GetThreadPool() const;
     int GetDocumentCount() const;
     std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
         const std::string& raw_query,
@@ -58,17 +182,75 @@ public:
         const std::execution::parallel_policy&,
         const std::string& raw_query,
         int document_id) const;
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> MatchDocuments(
+        const std::string& raw_query,
+        const std::vector<int>& document_ids) const;
     const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
     void RemoveDocument(int document_id);
     void RemoveDocument(const std::execution::sequenced_policy&, int document_id);
     void RemoveDocument(const std::execution::parallel_policy&, int document_id);
+    void RemoveDocuments(const std::vector<int>& document_ids);
+    void MergeIndexSegments();
+    InvertedIndex::MemoryStats GetIndexMemoryStats() const;
+    TextArena::MemoryStats GetTextMemoryStats() const;
+    void Save(const std::string& path) const;
 
 private:
+    static constexpr int NO_INTERNAL_ID = -1;
+    /*     ,          */
+    static constexpr size_t CANCELLATION_CHECK_INTERVAL = 1024;
+
     struct DocumentData {
+        int id;
         int rating;
         DocumentStatus status;
     };
 
+    /*     ,       */
+    struct MappedDocuments {
+        Span<DocumentData> documents;
+        Span<int> sorted_document_ids;   /*!<     */
+        Span<int> sorted_internal_ids;   /*!<       */
+        Span<char> text_chars;
+        Span<uint64_t> text_offsets;     /*!<    text_chars    */
+        Span<uint64_t> forward_offsets;  /*!<     forward_term_ids */
+        Span<int> forward_term_ids;      /*!<       */
+        Span<double> forward_term_freqs;
+    };
+
+    /*     ,     ,
+         ,  ,     , 
+        .    ,     , 
+             */
+    struct QueryCache {
+        explicit QueryCache(size_t capacity)
+            : raw_entries(capacity)
+            , entries(capacity)
+        {
+        }
+
+        std::mutex mutex;
+        LruCache<std::string, std::shared_ptr<const PreparedQuery>> raw_entries;
+        LruCache<std::string, std::shared_ptr<const PreparedQuery>> entries;
+    };
+
+    /*   :         */
+    struct DocumentTerms {
+        std::vector<int> term_ids;
+        std::vector<double> term_freqs;
+    };
+
+    /*      ,     GetWordFrequencies.
+            ,       */
+    struct WordFrequenciesCache {
+        WordFrequenciesCache() = default;
+        WordFrequenciesCache(const WordFrequenciesCache&);
+        WordFrequenciesCache& operator=(const WordFrequenciesCache& other);
+
+        std::mutex mutex;
+        std::map<int, std::map<std::string_view, double>> word_freqs; /*!<    */
+    };
+
     struct QueryWord {
         std::string_view data;
         bool is_minus;
@@ -80,38 +262,179 @@ private:
         std::vector<std::string_view> minus_words;
     };
 
+    /*  ,   ,      */
+    struct QueryTerms {
+        std::vector<std::pair<int, size_t>> plus_terms; /*!<      plus_words,    */
+        std::vector<int> minus_term_ids;                /*!<   */
+    };
+
+    struct PreparedDocument {
+        std::vector<std::pair<std::string_view, int>> word_counts;   /*!<     */
+        int word_count = 0;                                          /*!<     */
+        std::exception_ptr error;                                    /*!<    */
+    };
+
     const std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::set<int> document_ids_;
-    std::set<std::string, std::less<>> all_documenst_; /*!<    */
+    StopWordSet stop_word_set_; /*!<    ,   stop_words_ */
+    InvertedIndex index_;
+    /*!     ,   .   
+              :     ,
+               */
+    ChunkedVector<std::shared_ptr<const DocumentTerms>> document_terms_;
+    mutable WordFrequenciesCache word_freqs_cache_;
+    ChunkedMap<int, int> document_to_internal_id_; /*!<      */
+    ChunkedVector<DocumentData> documents_; /*!<      */
+    /*!     ,    . 
+          document_chars_    ,       */
+    ChunkedVector<std::string_view> document_texts_;
+    TextArena document_chars_;
+    /*!  ,    .      
+          (is_mapped_),         */
+    std::shared_ptr<const MappedFile> index_file_;
+    MappedDocuments mapped_documents_;
+    bool is_mapped_ = false;
+    uint64_t generation_ = NextGeneration(); /*!<  ,     */
+    /*!   .        */
+    std::shared_ptr<QueryCache> query_cache_ = std::make_shared<QueryCache>(QUERY_CACHE_CAPACITY);
+    /*!    .   ,       */
+    TermWeightTable term_weights_;
+    bool is_term_weight_table_enabled_ = true;
+    /*!  , ,  .   ,     */
+    std::shared_ptr<ResultCache> result_cache_;
+    /*!     ,   .  ,
+         std::execution::par */
+    std::shared_ptr<ThreadPool> thread_pool_;
+
+    explicit SearchServer(const IndexFileReader& reader);
+    static std::set<std::string, std::less<>> ReadStopWords(const IndexFileReader& reader);
+    void Detach();
+    static uint64_t NextGeneration();
+    void UpdateGeneration();
+    int FindInternalId(int document_id) const;
+    int GetInternalDocumentCount() const;
+    const DocumentData& GetDocumentData(int internal_id) const;
+    std::string_view GetDocumentText(int internal_id) const;
+    Span<int> GetDocumentTermIds(int internal_id) const;
+    Span<double> GetDocumentTermFreqs(int internal_id) const;
+    static std::shared_ptr<const DocumentTerms> MakeDocumentTerms(std::vector<std::pair<int, int>> term_counts,
+                                                                  int word_count);
+    void ReleaseDocumentText(int internal_id);
 
     bool IsStopWord(std::string_view word) const;
     static bool IsValidWord(std::string_view word);
     std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text) const;
     static int ComputeAverageRating(const std::vector<int>& ratings);
-    QueryWord ParseQueryWord(std::string_view text) const;
+    void CheckNewDocumentIds(const std::vector<RawDocument>& documents) const;
+    PreparedDocument PrepareDocument(const RawDocument& document) const;
+    void AddPreparedDocuments(const std::vector<RawDocument>& documents,
+                              std::vector<PreparedDocument>& prepared_documents);
+    QueryWord ParseQueryWord(std::string_view text, bool is_valid_word) const;
     SearchServer::Query ParseQuery(std::string_view text,
                                    bool sort_and_delete = true) const;
-    double ComputeWordInverseDocumentFreq(std::string_view word) const;
+    std::shared_ptr<const PreparedQuery> GetPreparedQuery(std::string_view raw_query) const;
+    std::string MakeResultCacheKey(const PreparedQuery& prepared_query,
+                                   DocumentStatus status,
+                                   const SearchOptions& options,
+                                   const std::string& ranking_key) const;
+    CollectionStats GetCollectionStats() const;
+    double ComputeWordInverseDocumentFreq(int term_id) const;
+    TermWeightTable::TermWeight ComputeTermWeight(int term_id) const;
+    TermWeightTable::TermWeight GetTermWeight(int term_id) const;
+    void FindTopDocumentsShared(const std::vector<const PreparedQuery*>& queries,
+                                std::vector<std::vector<Document>*>& results) const;
+    QueryTerms FindQueryTerms(const Query& query) const;
+    std::vector<std::string_view> MatchQueryTerms(const Query& query,
+                                                  const QueryTerms& query_terms,
+                                                  int internal_id) const;
+    static const int* GallopLowerBound(const int* first, const int* last, int value);
 
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query& query,
-                                           DocumentPredicate document_predicate) const;
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&,
-                                           const Query& query,
-                                           DocumentPredicate document_predicate) const;
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&,
-                                           const Query& query,
-                                           DocumentPredicate document_predicate) const;
+    size_t GetThreadCount() const;
+    template <typename Function>
+    void RunParallel(size_t count, Function function) const;
+
+    template <typename Function>
+    bool ForEachPosting(int term_id,
+                        int first_internal_id,
+                        int last_internal_id,
+                        Function function,
+                        const CancellationToken& cancellation = CancellationToken()) const;
+
+    template <typename DocumentPredicate, typename TermScorer>
+    void FindAllDocuments(const PreparedQuery& query,
+                          const std::vector<TermScorer>& term_scorers,
+                          DocumentPredicate document_predicate,
+                          const CancellationToken& cancellation,
+                          int first_internal_id,
+                          int last_internal_id,
+                          TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename TermScorer>
+    void FindTopDocumentsWand(const PreparedQuery& query,
+                              const std::vector<TermScorer>& term_scorers,
+                              DocumentPredicate document_predicate,
+                              const CancellationToken& cancellation,
+                              size_t segment,
+                              int first_internal_id,
+                              int last_internal_id,
+                              TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename Ranking>
+    void FindTopDocumentsInRange(const PreparedQuery& query,
+                                 DocumentPredicate document_predicate,
+                                 const SearchOptions& options,
+                                 const Ranking& ranking,
+                                 int first_internal_id,
+                                 int last_internal_id,
+                                 TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename Ranking>
+    void FindTopDocuments(const std::execution::sequenced_policy&,
+                          const PreparedQuery& query,
+                          DocumentPredicate document_predicate,
+                          const SearchOptions& options,
+                          const Ranking& ranking,
+                          TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename Ranking>
+    void FindTopDocuments(const std::execution::parallel_policy&,
+                          const PreparedQuery& query,
+                          DocumentPredicate document_predicate,
+                          const SearchOptions& options,
+                          const Ranking& ranking,
+                          TopDocuments& top_documents) const;
 };
 
+/*! \fn SearchServer::GetInternalDocumentCount
+ *  \b   \b :   \n
+ *  \b   \b :   ,    \n
+ *  \b  \b :  \n
+ *  \return    \n
+ */
+inline int SearchServer::GetInternalDocumentCount() const {
+    return static_cast<int>(is_mapped_ ? mapped_documents_.documents.size() : documents_.size());
+}
+
+inline const SearchServer::DocumentData& SearchServer::GetDocumentData(int internal_id) const {
+    return is_mapped_ ? mapped_documents_.documents[internal_id] : documents_[internal_id];
+}
+
 template <typename StringContainer>
 SearchServer::SearchServer(const StringContainer& stop_words)
     : stop_words_(MakeUniqueNonEmptyStrings(stop_words))
+    , stop_word_set_(stop_words_)
+{
+    if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
+        throw std::invalid_argument("Some of stop words are invalid");
+    }
+}
+
+/*! \fn SearchServer::SearchServer
+ *  \b   \b :   \n
+ *  \b   \b :    -, -  
+ *                       .     \n
+ *  \b  \b :  \n
+ *  \param[in] stop_words - \n
+ */
+template <size_t N>
+SearchServer::SearchServer(const StaticStopWords<N>& stop_words)
+    : stop_words_(MakeUniqueNonEmptyStrings(stop_words))
+    , stop_word_set_(stop_words)
 {
     if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
         throw std::invalid_argument("Some of stop words are invalid");
@@ -123,10 +446,7 @@ std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& poli
                                                      const std::string_view raw_query,
                                                      DocumentStatus status) const
 {
-    return FindTopDocuments(policy, raw_query,
-        [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
+    return FindTopDocuments(policy, raw_query, status, SearchOptions{});
 }
 
 template <typename ExecutionPolicy>
@@ -148,106 +468,578 @@ std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& poli
                                                      const std::string_view raw_query,
                                                      DocumentPredicate document_predicate) const
 {
-    static const double EPS = 1e-6;
+    return FindTopDocuments(policy, raw_query, document_predicate, SearchOptions{});
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const std::string_view raw_query,
+                                                     DocumentStatus status,
+                                                     const SearchOptions& options) const
+{
+    return FindTopDocuments(policy, raw_query, status, options, TfIdfRanking{});
+}
 
-    const Query query = ParseQuery(raw_query);
-    std::vector<Document> matched_documents = FindAllDocuments(policy, query, document_predicate);
+template <typename ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const std::string_view raw_query,
+                                                     DocumentPredicate document_predicate,
+                                                     const SearchOptions& options) const
+{
+    return FindTopDocuments(policy, raw_query, document_predicate, options, TfIdfRanking{});
+}
 
-    sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < EPS) {
-                return lhs.rating > rhs.rating;
-            }
-            return lhs.relevance > rhs.relevance;
-        });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+/*! \fn SearchServer::FindTopDocuments
+ *  \b   \b :   \n
+ *  \b   \b :          \n
+ *  \b  \b :   - TfIdfRanking, Bm25Ranking     
+ *                      , . ranking.h \n
+ *  \param[in] policy   \n
+ *  \param[in] raw_query   \n
+ *  \param[in] status   \n
+ *  \param[in] options   \n
+ *  \param[in] ranking   \n
+ *  \return   \n
+ */
+template <typename ExecutionPolicy, typename Ranking>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const std::string_view raw_query,
+                                                     DocumentStatus status,
+                                                     const SearchOptions& options,
+                                                     const Ranking& ranking) const
+{
+    return FindTopDocuments(policy, *GetPreparedQuery(raw_query), status, options, ranking);
+}
+
+template <typename ExecutionPolicy, typename DocumentPredicate, typename Ranking>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const std::string_view raw_query,
+                                                     DocumentPredicate document_predicate,
+                                                     const SearchOptions& options,
+                                                     const Ranking& ranking) const
+{
+    return FindTopDocuments(policy, *GetPreparedQuery(raw_query), document_predicate, options, ranking);
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const PreparedQuery& prepared_query) const
+{
+    return FindTopDocuments(policy, prepared_query, DocumentStatus::ACTUAL, SearchOptions{});
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const PreparedQuery& prepared_query,
+                                                     DocumentStatus status,
+                                                     const SearchOptions& options) const
+{
+    return FindTopDocuments(policy, prepared_query, status, options, TfIdfRanking{});
+}
+
+template <typename ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const PreparedQuery& prepared_query,
+                                                     DocumentPredicate document_predicate,
+                                                     const SearchOptions& options) const
+{
+    return FindTopDocuments(policy, prepared_query, document_predicate, options, TfIdfRanking{});
+}
+
+/*! \fn SearchServer::FindTopDocuments
+ *  \b   \b :   \n
+ *  \b   \b :        .
+ *                         ,      ,
+ *                      ,  ,      \n
+ *  \b  \b :     ,   
+ *                        ,     . 
+ *                           \n
+ *  \param[in] policy   \n
+ *  \param[in] prepared_query   \n
+ *  \param[in] status   \n
+ *  \param[in] options   \n
+ *  \param[in] ranking   \n
+ *  \return   \n
+ */
+template <typename ExecutionPolicy, typename Ranking>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const PreparedQuery& prepared_query,
+                                                     DocumentStatus status,
+                                                     const SearchOptions& options,
+                                                     const Ranking& ranking) const
+{
+    if (prepared_query.generation_ != generation_) {
+        return FindTopDocuments(policy, prepared_query.text_, status, options, ranking);
     }
 
-    return matched_documents;
+    auto document_predicate = [status](int, DocumentStatus document_status, int) {
+        return document_status == status;
+    };
+    const std::shared_ptr<ResultCache> cache = result_cache_;
+    if (!cache) {
+        return FindTopDocuments(policy, prepared_query, document_predicate, options, ranking);
+    }
+
+    const std::string key = MakeResultCacheKey(prepared_query, status, options, ranking.GetCacheKey());
+    if (auto documents = cache->Find(key)) {
+        return std::move(*documents);
+    }
+    auto documents = FindTopDocuments(policy, prepared_query, document_predicate, options, ranking);
+    if (!options.cancellation.IsCancelled()) {
+        cache->Put(key, documents);
+    }
+    return documents;
 }
 
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query,
-                                                     DocumentPredicate document_predicate) const
+/*! \fn SearchServer::FindTopDocuments
+ *  \b   \b :   \n
+ *  \b   \b :         
+ *                           \n
+ *  \b  \b :     ,    \n
+ *  \param[in] policy   \n
+ *  \param[in] prepared_query   \n
+ *  \param[in] document_predicate   \n
+ *  \param[in] options   \n
+ *  \param[in] ranking   \n
+ *  \return   \n
+ */
+template <typename ExecutionPolicy, typename DocumentPredicate, typename Ranking>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy,
+                                                     const PreparedQuery& prepared_query,
+                                                     DocumentPredicate document_predicate,
+                                                     const SearchOptions& options,
+                                                     const Ranking& ranking) const
 {
-    std::map<int, double> document_to_relevance;
+    if (prepared_query.generation_ != generation_) {
+        return FindTopDocuments(policy, prepared_query.text_, document_predicate, options, ranking);
+    }
 
-    for (std::string_view word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+    TopDocuments top_documents(options.max_result_count);
+    FindTopDocuments(policy, prepared_query, document_predicate, options, ranking, top_documents);
+    return top_documents.Extract();
+}
+
+template <typename DocumentPredicate, typename Ranking>
+void SearchServer::FindTopDocuments(const std::execution::sequenced_policy&,
+                                    const PreparedQuery& query,
+                                    DocumentPredicate document_predicate,
+                                    const SearchOptions& options,
+                                    const Ranking& ranking,
+                                    TopDocuments& top_documents) const
+{
+    FindTopDocumentsInRange(query, document_predicate, options, ranking,
+        0, GetInternalDocumentCount(), top_documents);
+}
+
+/*! \fn SearchServer::FindTopDocuments
+ *  \b   \b :   \n
+ *  \b   \b :    .  
+ *                         ,   
+ *                              ,
+ *                            \n
+ *  \b  \b :  \n
+ *  \param[in] query  \n
+ *  \param[in] document_predicate   \n
+ *  \param[in] options   \n
+ *  \param[in] ranking   \n
+ *  \param[out] top_documents    \n
+ *  \return  \n
+ */
+template <typename DocumentPredicate, typename Ranking>
+void SearchServer::FindTopDocuments(const std::execution::parallel_policy&,
+                                    const PreparedQuery& query,
+                                    DocumentPredicate document_predicate,
+                                    const SearchOptions& options,
+                                    const Ranking& ranking,
+                                    TopDocuments& top_documents) const
+{
+    /*   MIN_SHARD_SIZE    .  ,  ,
+                */
+    static const size_t MIN_SHARD_SIZE = 2048;
+    static const size_t SHARDS_PER_THREAD = 4;
+
+    const size_t document_count = GetInternalDocumentCount();
+    const size_t shard_count = std::max<size_t>(1, std::min(
+        (document_count + MIN_SHARD_SIZE - 1) / MIN_SHARD_SIZE,
+        GetThreadCount() * SHARDS_PER_THREAD));
+    if (shard_count == 1) {
+        FindTopDocuments(std::execution::seq, query, document_predicate, options, ranking, top_documents);
+        return;
+    }
+
+    const size_t shard_size = (document_count + shard_count - 1) / shard_count;
+    std::vector<TopDocuments> shard_top_documents(shard_count, TopDocuments(top_documents.GetCapacity()));
+    RunParallel(shard_count,
+        [&](size_t shard) {
+            const size_t first = std::min(document_count, shard * shard_size);
+            const size_t last = std::min(document_count, first + shard_size);
+            FindTopDocumentsInRange(query, document_predicate, options, ranking,
+                static_cast<int>(first), static_cast<int>(last), shard_top_documents[shard]);
+        });
+    for (const auto& shard_top : shard_top_documents) {
+        top_documents.Merge(shard_top);
+    }
+}
+
+/*! \fn SearchServer::FindTopDocumentsInRange
+ *  \b   \b :   \n
+ *  \b   \b :       .
+ *                       -        \n
+ *  \b  \b :  \n
+ *  \param[in] query  \n
+ *  \param[in] document_predicate   \n
+ *  \param[in] options   \n
+ *  \param[in] ranking   \n
+ *  \param[in] first_internal_id     \n
+ *  \param[in] last_internal_id      \n
+ *  \param[out] top_documents    \n
+ *  \return  \n
+ */
+template <typename DocumentPredicate, typename Ranking>
+void SearchServer::FindTopDocumentsInRange(const PreparedQuery& query,
+                                           DocumentPredicate document_predicate,
+                                           const SearchOptions& options,
+                                           const Ranking& ranking,
+                                           int first_internal_id,
+                                           int last_internal_id,
+                                           TopDocuments& top_documents) const
+{
+    const CollectionStats collection = GetCollectionStats();
+    std::vector<typename Ranking::TermScorer> term_scorers;
+    term_scorers.reserve(query.plus_terms_.size());
+    for (const PreparedQuery::Term& term : query.plus_terms_) {
+        term_scorers.push_back(ranking.MakeTermScorer(collection, { index_.GetDocumentFreq(term.term_id),
+            term.inverse_document_freq, term.max_term_freq, term.max_impact }));
+    }
+
+    if (options.scoring_mode == ScoringMode::WAND) {
+        /*         ,
+                   top_documents.  
+                ,     */
+        double max_relevance = 0.0;
+        for (const auto& term_scorer : term_scorers) {
+            max_relevance += term_scorer.GetMaxImpact();
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+        for (size_t segment = 0; segment < index_.GetSegmentCount(); ++segment) {
+            if (options.cancellation.IsCancelled()) {
+                break;
+            }
+            if (top_documents.GetSize() > 0 && top_documents.IsFull() &&
+                max_relevance <= top_documents.GetWorst().relevance - 2 * RELEVANCE_EPS) {
+                break;
+            }
+            const int first = std::max(first_internal_id, index_.GetSegmentFirstDocumentId(segment));
+            const int last = std::min(last_internal_id, index_.GetSegmentEndDocumentId(segment));
+            if (first < last) {
+                FindTopDocumentsWand(query, term_scorers, document_predicate, options.cancellation,
+                    segment, first, last, top_documents);
             }
         }
     }
+    else {
+        FindAllDocuments(query, term_scorers, document_predicate, options.cancellation,
+            first_internal_id, last_internal_id, top_documents);
+    }
+}
+
+/*! \fn SearchServer::RunParallel
+ *  \b   \b :   \n
+ *  \b   \b :   function(i)  i  [0, count)   ,
+ *                          std::execution::par \n
+ *  \b  \b :    ,     
+ *                        .      ,  
+ *                           std::terminate \n
+ *  \param[in] count   \n
+ *  \param[in] function ,   \n
+ *  \return  \n
+ */
+template <typename Function>
+void SearchServer::RunParallel(size_t count, Function function) const {
+    if (thread_pool_) {
+        thread_pool_->ParallelFor(count, function);
+        return;
+    }
+    std::vector<size_t> indexes(count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::for_each(std::execution::par, indexes.cbegin(), indexes.cend(),
+        [&function, &error_mutex, &error](size_t i) {
+            try {
+                function(i);
+            }
+            catch (...) {
+                std::lock_guard guard(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
 
-    for (std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+/*! \fn SearchServer::ForEachPosting
+ *  \b   \b :   \n
+ *  \b   \b :         
+ *                          \n
+ *  \b  \b :  ,    ,  .
+ *                          CANCELLATION_CHECK_INTERVAL  \n
+ *  \param[in] term_id   \n
+ *  \param[in] first_internal_id     \n
+ *  \param[in] last_internal_id      \n
+ *  \param[in] function ,   ,    \n
+ *  \param[in] cancellation   \n
+ *  \return false,     \n
+ */
+template <typename Function>
+bool SearchServer::ForEachPosting(int term_id,
+                                  int first_internal_id,
+                                  int last_internal_id,
+                                  Function function,
+                                  const CancellationToken& cancellation) const
+{
+    size_t step = 0;
+    for (size_t segment = 0; segment < index_.GetSegmentCount(); ++segment) {
+        if (index_.GetSegmentEndDocumentId(segment) <= first_internal_id ||
+            index_.GetSegmentFirstDocumentId(segment) >= last_internal_id) {
             continue;
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        InvertedIndex::PostingIterator iterator(index_.GetPostings(segment, term_id),
+            first_internal_id, last_internal_id);
+        for (; !iterator.IsEnd(); iterator.Next()) {
+            if (++step % CANCELLATION_CHECK_INTERVAL == 0 && cancellation.IsCancelled()) {
+                return false;
+            }
+            function(iterator);
         }
     }
-
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back(
-            { document_id, relevance, documents_.at(document_id).rating });
-    }
-    return matched_documents;
+    return true;
 }
 
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
-                                                     const Query& query,
-                                                     DocumentPredicate document_predicate) const
+/*! \fn SearchServer::FindAllDocuments
+ *  \b   \b :   \n
+ *  \b   \b :     ,  - \n
+ *  \b  \b :         .
+ *                           -   ,  
+ *                       -        \n
+ *  \param[in] query  \n
+ *  \param[in] term_scorers  -  \n
+ *  \param[in] document_predicate   \n
+ *  \param[in] cancellation   \n
+ *  \param[in] first_internal_id     \n
+ *  \param[in] last_internal_id      \n
+ *  \param[out] top_documents    \n
+ *  \return  \n
+ */
+template <typename DocumentPredicate, typename TermScorer>
+void SearchServer::FindAllDocuments(const PreparedQuery& query,
+                                    const std::vector<TermScorer>& term_scorers,
+                                    DocumentPredicate document_predicate,
+                                    const CancellationToken& cancellation,
+                                    int first_internal_id,
+                                    int last_internal_id,
+                                    TopDocuments& top_documents) const
 {
-    return FindAllDocuments(query, document_predicate);
+    ScoringWorkspace::Lease workspace(GetInternalDocumentCount());
+
+    /* -  ,       */
+    for (const int term_id : query.minus_term_ids_) {
+        if (cancellation.IsCancelled() ||
+            !ForEachPosting(term_id, first_internal_id, last_internal_id,
+                [&workspace](const InvertedIndex::PostingIterator& posting) {
+                    workspace->Veto(posting.GetDocumentId());
+                }, cancellation)) {
+            return;
+        }
+    }
+
+    auto document_filter = [this, &document_predicate](int internal_id) {
+        const auto& document_data = GetDocumentData(internal_id);
+        return !index_.IsDeleted(internal_id) &&
+            document_predicate(document_data.id, document_data.status, document_data.rating);
+    };
+    for (size_t i = 0; i < query.plus_terms_.size(); ++i) {
+        if (cancellation.IsCancelled()) {
+            break;
+        }
+        const TermScorer term_scorer = term_scorers[i];
+        if (!ForEachPosting(query.plus_terms_[i].term_id, first_internal_id, last_internal_id,
+                [&workspace, &document_filter, term_scorer](const InvertedIndex::PostingIterator& posting) {
+                    workspace->Add(posting.GetDocumentId(), term_scorer.Score(posting), document_filter);
+                }, cancellation)) {
+            break;
+        }
+    }
+
+    workspace->ForEachScored([this, &top_documents](int internal_id, double relevance) {
+        const auto& document_data = GetDocumentData(internal_id);
+        top_documents.Add({ document_data.id, relevance, document_data.rating });
+    });
 }
 
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
-                                                     const Query& query,
-                                                     DocumentPredicate document_predicate) const
+/*! \fn SearchServer::FindTopDocumentsWand
+ *  \b   \b :   \n
+ *  \b   \b :     Block-Max WAND.  
+ *                          . ,  
+ *                               
+ *                         ,    \n
+ *  \b  \b :     .    .
+ *                         ,      \n
+ *  \param[in] query  \n
+ *  \param[in] term_scorers  -  \n
+ *  \param[in] document_predicate   \n
+ *  \param[in] cancellation   \n
+ *  \param[in] segment    \n
+ *  \param[in] first_internal_id     \n
+ *  \param[in] last_internal_id      \n
+ *  \param[out] top_documents    \n
+ *  \return  \n
+ */
+template <typename DocumentPredicate, typename TermScorer>
+void SearchServer::FindTopDocumentsWand(const PreparedQuery& query,
+                                        const std::vector<TermScorer>& term_scorers,
+                                        DocumentPredicate document_predicate,
+                                        const CancellationToken& cancellation,
+                                        size_t segment,
+                                        int first_internal_id,
+                                        int last_internal_id,
+                                        TopDocuments& top_documents) const
 {
-    static const size_t BUCKET_COUNT = 10;
+    struct Cursor {
+        InvertedIndex::PostingIterator iterator;
+        TermScorer term_scorer;
 
-    ConcurrentMap<int, double> document_to_relevance(BUCKET_COUNT);
-    auto plus_word = [this, &query, document_predicate, &document_to_relevance](std::string_view word) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            return;
+        bool IsEnd() const {
+            return iterator.IsEnd();
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
-            }
+
+        int GetDocumentId() const {
+            return iterator.GetDocumentId();
+        }
+
+        int GetBlockLastDocumentId() const {
+            return iterator.GetBlockLastDocumentId();
+        }
+
+        double GetBlockMaxRelevance() const {
+            return term_scorer.GetBlockMaxScore(iterator.GetBlockMaxTermFreq());
+        }
+
+        void SkipTo(int document_id) {
+            iterator.SkipTo(document_id);
         }
     };
-    std::for_each(std::execution::par, query.plus_words.cbegin(), query.plus_words.cend(), plus_word);
 
-    auto minus_word = [this, &document_to_relevance](std::string_view word) {
-        if (word_to_document_freqs_.count(word) == 0) {
+    if (top_documents.GetCapacity() == 0) {
+        return;
+    }
+
+    /* -    -:    
+         ,      */
+    std::vector<InvertedIndex::PostingIterator> minus_iterators;
+    for (const int term_id : query.minus_term_ids_) {
+        minus_iterators.emplace_back(index_.GetPostings(segment, term_id), first_internal_id, last_internal_id);
+    }
+    auto has_minus_word = [&minus_iterators](int document_id) {
+        return std::any_of(minus_iterators.begin(), minus_iterators.end(),
+            [document_id](InvertedIndex::PostingIterator& iterator) {
+                iterator.SkipTo(document_id);
+                return !iterator.IsEnd() && iterator.GetDocumentId() == document_id;
+            });
+    };
+
+    /*      ,     ,
+           */
+    std::vector<Cursor> cursors;
+    cursors.reserve(query.plus_terms_.size());
+    for (size_t i = 0; i < query.plus_terms_.size(); ++i) {
+        InvertedIndex::PostingIterator iterator(index_.GetPostings(segment, query.plus_terms_[i].term_id),
+            first_internal_id, last_internal_id);
+        if (!iterator.IsEnd()) {
+            cursors.push_back({ iterator, term_scorers[i] });
+        }
+    }
+
+    std::vector<Cursor*> ordered_cursors;
+    ordered_cursors.reserve(cursors.size());
+    for (Cursor& cursor : cursors) {
+        ordered_cursors.push_back(&cursor);
+    }
+
+    for (size_t step = 1; !ordered_cursors.empty(); ++step) {
+        if (step % CANCELLATION_CHECK_INTERVAL == 0 && cancellation.IsCancelled()) {
             return;
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.Erase(document_id);
+        /*      ,    */
+        for (size_t i = 1; i < ordered_cursors.size(); ++i) {
+            Cursor* cursor = ordered_cursors[i];
+            size_t j = i;
+            for (; j > 0 && ordered_cursors[j - 1]->GetDocumentId() > cursor->GetDocumentId(); --j) {
+                ordered_cursors[j] = ordered_cursors[j - 1];
+            }
+            ordered_cursors[j] = cursor;
+        }
+
+        /*     ,       
+                RELEVANCE_EPS.    .
+                  horizon_document_id */
+        size_t pivot = 0;
+        int horizon_document_id = std::numeric_limits<int>::max();
+        if (top_documents.IsFull()) {
+            const double threshold = top_documents.GetWorst().relevance - 2 * RELEVANCE_EPS;
+            double upper_bound = 0.0;
+            for (const Cursor* cursor : ordered_cursors) {
+                horizon_document_id = std::min(horizon_document_id, cursor->GetBlockLastDocumentId());
+            }
+            for (; pivot < ordered_cursors.size(); ++pivot) {
+                upper_bound += ordered_cursors[pivot]->GetBlockMaxRelevance();
+                if (upper_bound > threshold) {
+                    break;
+                }
+            }
+        }
+
+        if (pivot == ordered_cursors.size() ||
+            ordered_cursors[pivot]->GetDocumentId() > horizon_document_id) {
+            for (Cursor* cursor : ordered_cursors) {
+                if (cursor->GetDocumentId() > horizon_document_id) {
+                    break;
+                }
+                cursor->SkipTo(horizon_document_id + 1);
+            }
+        }
+        else if (ordered_cursors.front()->GetDocumentId() == ordered_cursors[pivot]->GetDocumentId()) {
+            const int document_id = ordered_cursors.front()->GetDocumentId();
+            const auto& document_data = GetDocumentData(document_id);
+            if (!index_.IsDeleted(document_id) && !has_minus_word(document_id) &&
+                document_predicate(document_data.id, document_data.status, document_data.rating)) {
+                double relevance = 0.0;
+                for (const Cursor& cursor : cursors) {
+                    if (!cursor.IsEnd() && cursor.GetDocumentId() == document_id) {
+                        relevance += cursor.term_scorer.Score(cursor.iterator);
+                    }
+                }
+                top_documents.Add({ document_data.id, relevance, document_data.rating });
+            }
+            for (Cursor* cursor : ordered_cursors) {
+                if (cursor->GetDocumentId() != document_id) {
+                    break;
+                }
+                cursor->iterator.Next();
+            }
+        }
+        else {
+            const int pivot_document_id = ordered_cursors[pivot]->GetDocumentId();
+            for (size_t i = 0; i < pivot; ++i) {
+                ordered_cursors[i]->SkipTo(pivot_document_id);
+            }
         }
-    };
-    std::for_each(std::execution::par, query.minus_words.cbegin(), query.minus_words.cend(), minus_word);
 
-    auto document_to_relevance_ordinary = document_to_relevance.BuildOrdinaryMap();
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance_ordinary) {
-        matched_documents.push_back(
-            { document_id, relevance, documents_.at(document_id).rating });
+        ordered_cursors.erase(std::remove_if(ordered_cursors.begin(), ordered_cursors.end(),
+            [](const Cursor* cursor) {
+                return cursor->IsEnd();
+            }), ordered_cursors.end());
     }
-    return matched_documents;
 }
@@ -0,0 +1,68 @@
+#include "stop_words.h"
+
+StopWordSet::StopWordSet()
+    : StopWordSet(nullptr, 0, nullptr, 0)
+{
+}
+
+/*! \fn StopWordSet::StopWordSet
+ *  \b   \b :   \n
+ *  \b   \b :    -  -.
+ *                        -    ,   \n
+ *  \b  \b :    \n
+ *  \param[in] words - \n
+ */
+StopWordSet::StopWordSet(const std::set<std::string, std::less<>>& words)
+{
+    std::vector<std::string_view> unique_words;
+    for (const std::string& word : words) {
+        if (!word.empty()) {
+            unique_words.push_back(word);
+        }
+    }
+
+    const size_t word_count = unique_words.size();
+    const size_t bucket_count = PerfectHash::GetBucketCount(word_count);
+    std::vector<uint64_t> hashes(word_count);
+    std::vector<size_t> members(word_count);
+    std::vector<size_t> bucket_offsets(bucket_count + 1);
+    std::vector<uint32_t> seeds(bucket_count);
+    std::vector<std::string_view> slots;
+    for (size_t slot_count = word_count;; slot_count += word_count / 8 + 1) {
+        if (slot_count > 2 * word_count + 1) {
+            throw std::runtime_error("Cannot build perfect hash for stop words");
+        }
+        slots.assign(slot_count, {});
+        if (PerfectHash::Build(unique_words, word_count, hashes, members, bucket_offsets,
+            seeds, bucket_count, slots, slot_count)) {
+            break;
+        }
+    }
+    *this = StopWordSet(seeds.data(), bucket_count, slots.data(), slots.size());
+}
+
+/*   ,       */
+StopWordSet::StopWordSet(const uint32_t* seeds, size_t bucket_count,
+                         const std::string_view* slots, size_t slot_count)
+{
+    auto storage = std::make_shared<Storage>();
+    storage->seeds.assign(seeds, seeds + bucket_count);
+    if (storage->seeds.empty()) {
+        storage->seeds.push_back(0);
+    }
+    storage->words.reserve(slot_count);
+    storage->slots.resize(slot_count);
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        if (!slots[slot].empty()) {
+            storage->words.emplace_back(slots[slot]);
+            storage->slots[slot] = storage->words.back();
+            length_mask_ |= PerfectHash::GetLengthBit(slots[slot].size());
+        }
+    }
+
+    seeds_ = storage->seeds.data();
+    slots_ = storage->slots.data();
+    bucket_count_ = storage->seeds.size();
+    slot_count_ = slot_count;
+    storage_ = std::move(storage);
+}
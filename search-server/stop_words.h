@@ -0,0 +1,246 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+template <size_t N>
+class StaticStopWords;
+
+/*    -  hash and displace.
+      ,   ,    ,
+    ,           */
+class PerfectHash {
+public:
+    static constexpr uint32_t MAX_SEED = 1 << 20;
+
+    static constexpr size_t GetBucketCount(size_t word_count) {
+        return word_count / 4 + 1;
+    }
+
+    /* FNV-1a     :      FNV-1a 
+           ,      */
+    static constexpr uint64_t Hash(std::string_view word) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c : word) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+        hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+        return hash ^ (hash >> 33);
+    }
+
+    static constexpr size_t GetBucket(uint64_t hash, size_t bucket_count) {
+        return static_cast<size_t>(((hash >> 32) * bucket_count) >> 32);
+    }
+
+    static constexpr size_t GetSlot(uint64_t hash, uint32_t seed, size_t slot_count) {
+        uint64_t mixed = hash + (seed + 1) * 0x9e3779b97f4a7c15ULL;
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+        mixed ^= mixed >> 31;
+        return static_cast<size_t>(((mixed & 0xffffffffULL) * slot_count) >> 32);
+    }
+
+    static constexpr uint64_t GetLengthBit(size_t length) {
+        return uint64_t(1) << (length < 63 ? length : 63);
+    }
+
+    template <typename Words, typename Hashes, typename Members, typename Offsets, typename Seeds, typename Slots>
+    static constexpr bool Build(const Words& words, size_t word_count, Hashes& hashes,
+                                Members& members, Offsets& bucket_offsets,
+                                Seeds& seeds, size_t bucket_count, Slots& slots, size_t slot_count);
+};
+
+/*   -.   -   
+      ,    */
+class StopWordSet {
+public:
+    StopWordSet();
+    explicit StopWordSet(const std::set<std::string, std::less<>>& words);
+    template <size_t N>
+    explicit StopWordSet(const StaticStopWords<N>& words);
+
+    bool Contains(std::string_view word) const;
+
+private:
+    struct Storage {
+        std::vector<std::string> words;
+        std::vector<uint32_t> seeds;
+        std::vector<std::string_view> slots; /*!<    - */
+    };
+
+    std::shared_ptr<const Storage> storage_;
+    const uint32_t* seeds_ = nullptr;
+    const std::string_view* slots_ = nullptr;
+    size_t bucket_count_ = 1;
+    size_t slot_count_ = 0;
+    uint64_t length_mask_ = 0; /*!<   -    */
+
+    StopWordSet(const uint32_t* seeds, size_t bucket_count, const std::string_view* slots, size_t slot_count);
+};
+
+/*  -, -     */
+template <size_t N>
+class StaticStopWords {
+public:
+    static constexpr size_t BUCKET_COUNT = PerfectHash::GetBucketCount(N);
+
+    constexpr explicit StaticStopWords(const std::string_view (&words)[N]);
+
+    constexpr bool Contains(std::string_view word) const;
+    const std::string_view* begin() const;
+    const std::string_view* end() const;
+
+private:
+    friend class StopWordSet;
+
+    std::array<uint32_t, BUCKET_COUNT> seeds_{};
+    std::array<std::string_view, N> slots_{};
+};
+
+/*! \fn PerfectHash::Build
+ *  \b   \b :   \n
+ *  \b   \b :    -.    
+ *                      ,      \n
+ *  \b  \b :       .  
+ *                        \n
+ *  \param[in] words  \n
+ *  \param[in] word_count   \n
+ *  \param[out] hashes, members, bucket_offsets    word_count, word_count
+ *               bucket_count + 1  \n
+ *  \param[out] seeds   \n
+ *  \param[in] bucket_count   \n
+ *  \param[out] slots  ,    \n
+ *  \param[in] slot_count  ,   word_count \n
+ *  \return false,   -     \n
+ */
+template <typename Words, typename Hashes, typename Members, typename Offsets, typename Seeds, typename Slots>
+constexpr bool PerfectHash::Build(const Words& words, size_t word_count, Hashes& hashes,
+                                  Members& members, Offsets& bucket_offsets,
+                                  Seeds& seeds, size_t bucket_count, Slots& slots, size_t slot_count)
+{
+    for (size_t bucket = 0; bucket <= bucket_count; ++bucket) {
+        bucket_offsets[bucket] = 0;
+    }
+    for (size_t i = 0; i < word_count; ++i) {
+        hashes[i] = Hash(words[i]);
+        ++bucket_offsets[GetBucket(hashes[i], bucket_count)];
+    }
+    size_t max_bucket_size = 0;
+    for (size_t bucket = 0, offset = 0; bucket < bucket_count; ++bucket) {
+        max_bucket_size = bucket_offsets[bucket] > max_bucket_size ? bucket_offsets[bucket] : max_bucket_size;
+        offset += bucket_offsets[bucket];
+        bucket_offsets[bucket] = offset;
+    }
+    bucket_offsets[bucket_count] = word_count;
+    for (size_t i = 0; i < word_count; ++i) {
+        members[--bucket_offsets[GetBucket(hashes[i], bucket_count)]] = i;
+    }
+
+    for (size_t size = max_bucket_size; size > 0; --size) {
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            const size_t first = bucket_offsets[bucket];
+            if (bucket_offsets[bucket + 1] - first != size) {
+                continue;
+            }
+            uint32_t seed = 0;
+            for (; seed < MAX_SEED; ++seed) {
+                size_t placed = 0;
+                for (; placed < size; ++placed) {
+                    const size_t word = members[first + placed];
+                    const size_t slot = GetSlot(hashes[word], seed, slot_count);
+                    if (!slots[slot].empty()) {
+                        break;
+                    }
+                    slots[slot] = words[word];
+                }
+                if (placed == size) {
+                    break;
+                }
+                /*   ,     */
+                for (size_t i = 0; i < placed; ++i) {
+                    slots[GetSlot(hashes[members[first + i]], seed, slot_count)] = {};
+                }
+            }
+            if (seed == MAX_SEED) {
+                return false;
+            }
+            seeds[bucket] = seed;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+StopWordSet::StopWordSet(const StaticStopWords<N>& words)
+    : StopWordSet(words.seeds_.data(), words.seeds_.size(), words.slots_.data(), words.slots_.size())
+{
+}
+
+/*! \fn StopWordSet::Contains
+ *  \b   \b :   \n
+ *  \b   \b : ,    -.   ,  
+ *                       -,     \n
+ *  \b  \b :  \n
+ *  \param[in] word  \n
+ *  \return true,   - \n
+ */
+inline bool StopWordSet::Contains(std::string_view word) const {
+    if ((length_mask_ & PerfectHash::GetLengthBit(word.size())) == 0) {
+        return false;
+    }
+    const uint64_t hash = PerfectHash::Hash(word);
+    const uint32_t seed = seeds_[PerfectHash::GetBucket(hash, bucket_count_)];
+    return slots_[PerfectHash::GetSlot(hash, seed, slot_count_)] == word;
+}
+
+/*! \fn StaticStopWords::StaticStopWords
+ *  \b   \b :   \n
+ *  \b   \b :  -   -,   .
+ *                      ,  constexpr,      \n
+ *  \b  \b :       ,   constexpr
+ *                        \n
+ *  \param[in] words - \n
+ */
+template <size_t N>
+constexpr StaticStopWords<N>::StaticStopWords(const std::string_view (&words)[N]) {
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, N> members{};
+    std::array<size_t, BUCKET_COUNT + 1> bucket_offsets{};
+    for (size_t i = 0; i < N; ++i) {
+        if (words[i].empty()) {
+            throw std::invalid_argument("Stop words must be non-empty");
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (words[i] == words[j]) {
+                throw std::invalid_argument("Stop words must be unique");
+            }
+        }
+    }
+    if (!PerfectHash::Build(words, N, hashes, members, bucket_offsets, seeds_, BUCKET_COUNT, slots_, N)) {
+        throw std::invalid_argument("Cannot build perfect hash for stop words");
+    }
+}
+
+template <size_t N>
+constexpr bool StaticStopWords<N>::Contains(std::string_view word) const {
+    const uint64_t hash = PerfectHash::Hash(word);
+    const uint32_t seed = seeds_[PerfectHash::GetBucket(hash, BUCKET_COUNT)];
+    return slots_[PerfectHash::GetSlot(hash, seed, N)] == word;
+}
+
+template <size_t N>
+const std::string_view* StaticStopWords<N>::begin() const {
+    return slots_.data();
+}
+
+template <size_t N>
+const std::string_view* StaticStopWords<N>::end() const {
+    return slots_.data() + N;
+}
@@ -1,17 +1,165 @@
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRING_PROCESSING_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "string_processing.h"
 
+namespace {
+
+#if defined(__AVX2__)
+const size_t CHUNK_SIZE = 32;
+#else
+const size_t CHUNK_SIZE = 16;
+#endif
+const uint32_t CHUNK_MASK = CHUNK_SIZE == 32 ? ~uint32_t(0) : (uint32_t(1) << CHUNK_SIZE) - 1;
+
+/*     offset    */
+uint32_t HighBits(size_t offset) {
+    return (~uint32_t(0) << offset) & CHUNK_MASK;
+}
+
+/*     offset */
+uint32_t LowBits(size_t offset) {
+    return offset == 0 ? 0 : ~uint32_t(0) >> (32 - offset);
+}
+
+size_t CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/*  CHUNK_SIZE :      ( 0-31) */
+void ClassifyChunk(const char* data, uint32_t& spaces, uint32_t& controls) {
+#if defined(__AVX2__)
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    /*   bytes <= 31   */
+    const __m256i is_control = _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, _mm256_set1_epi8(0x1F)), bytes);
+    spaces = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '))));
+    controls = static_cast<uint32_t>(_mm256_movemask_epi8(is_control));
+#elif defined(STRING_PROCESSING_SSE2)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i is_control = _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(0x1F)), bytes);
+    spaces = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '))));
+    controls = static_cast<uint32_t>(_mm_movemask_epi8(is_control));
+#else
+    spaces = 0;
+    controls = 0;
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        spaces |= static_cast<uint32_t>(c == ' ') << i;
+        controls |= static_cast<uint32_t>(c < ' ') << i;
+    }
+#endif
+}
+
+} // namespace
+
+WordTokenizer::WordTokenizer(std::string_view text)
+    : text_(text)
+{
+    LoadChunk(0);
+}
+
+/*! \fn WordTokenizer::Next
+ *  \b   \b :   \n
+ *  \b   \b :    .     16 
+ *                      32 ,         
+ *                        ,      \n
+ *  \b  \b :  \n
+ *  \return true,   , false,    \n
+ */
+bool WordTokenizer::Next() {
+    /*   -  ,    */
+    size_t word_begin = 0;
+    for (;;) {
+        if (position_ >= text_.size()) {
+            word_ = {};
+            return false;
+        }
+        if (position_ - chunk_begin_ == CHUNK_SIZE) {
+            LoadChunk(position_);
+        }
+        const uint32_t letters = ~spaces_ & HighBits(position_ - chunk_begin_);
+        if (letters != 0) {
+            word_begin = chunk_begin_ + CountTrailingZeros(letters);
+            break;
+        }
+        position_ = chunk_begin_ + CHUNK_SIZE;
+    }
+
+    /*   -  ,   ,      */
+    bool has_control = false;
+    position_ = word_begin;
+    for (;;) {
+        if (position_ - chunk_begin_ == CHUNK_SIZE) {
+            LoadChunk(position_);
+        }
+        const uint32_t rest = HighBits(position_ - chunk_begin_);
+        const uint32_t ends = spaces_ & rest;
+        if (ends != 0) {
+            const size_t word_end = CountTrailingZeros(ends);
+            has_control = has_control || (controls_ & rest & LowBits(word_end)) != 0;
+            position_ = chunk_begin_ + word_end;
+            break;
+        }
+        has_control = has_control || (controls_ & rest) != 0;
+        position_ = chunk_begin_ + CHUNK_SIZE;
+    }
+
+    word_ = text_.substr(word_begin, position_ - word_begin);
+    is_valid_word_ = !has_control;
+    return true;
+}
+
+std::string_view WordTokenizer::GetWord() const {
+    return word_;
+}
+
+/*! \fn WordTokenizer::IsValidWord
+ *  \b   \b :   \n
+ *  \b   \b :       ,
+ *                          \n
+ *  \b  \b :  \n
+ *  \return true,       \n
+ */
+bool WordTokenizer::IsValidWord() const {
+    return is_valid_word_;
+}
+
+void WordTokenizer::LoadChunk(size_t chunk_begin) {
+    chunk_begin_ = chunk_begin;
+    if (chunk_begin + CHUNK_SIZE <= text_.size()) {
+        ClassifyChunk(text_.data() + chunk_begin, spaces_, controls_);
+        return;
+    }
+    /*    ,       */
+    char chunk[CHUNK_SIZE];
+    std::memset(chunk, ' ', CHUNK_SIZE);
+    if (chunk_begin < text_.size()) {
+        std::memcpy(chunk, text_.data() + chunk_begin, text_.size() - chunk_begin);
+    }
+    ClassifyChunk(chunk, spaces_, controls_);
+}
+
 std::vector<std::string_view> SplitIntoWords(std::string_view text) {
     std::vector<std::string_view> result;
-    size_t pos = text.find_first_not_of(" ");
-    text.remove_prefix(std::min(text.size(), pos));
-    const size_t pos_end = text.npos;
-
-    while (!text.empty()) {
-        size_t space = text.find(' ');
-        result.push_back(space == pos_end ? text.substr(0, pos_end) : text.substr(0, space));
-        pos = text.find_first_not_of(" ", space);
-        text.remove_prefix(std::min(text.size(), pos));
+    WordTokenizer tokenizer(text);
+    while (tokenizer.Next()) {
+        result.push_back(tokenizer.GetWord());
     }
-
     return result;
 }
@@ -5,6 +5,28 @@
 #include <set>
 #include <algorithm>
 #include <string_view>
+#include <cstdint>
+
+/*    ,  ,      */
+class WordTokenizer {
+public:
+    explicit WordTokenizer(std::string_view text);
+
+    bool Next();
+    std::string_view GetWord() const;
+    bool IsValidWord() const;
+
+private:
+    std::string_view text_;
+    size_t position_ = 0;    /*!< ,     */
+    size_t chunk_begin_ = 0; /*!<     */
+    uint32_t spaces_ = 0;    /*!<   ,       */
+    uint32_t controls_ = 0;  /*!<     */
+    std::string_view word_;
+    bool is_valid_word_ = true;
+
+    void LoadChunk(size_t chunk_begin);
+};
 
 std::vector<std::string_view> SplitIntoWords(std::string_view text);
 
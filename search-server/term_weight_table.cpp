@@ -0,0 +1,42 @@
+#include <algorithm>
+
+#include "term_weight_table.h"
+
+/*        :    
+    ,        */
+TermWeightTable::TermWeightTable(const TermWeightTable& other)
+    : entries_(other.term_count_ > 0 ? new Entry[other.term_count_] : nullptr)
+    , term_count_(other.term_count_)
+    , capacity_(other.term_count_)
+    , version_(other.version_)
+{
+}
+
+TermWeightTable& TermWeightTable::operator=(const TermWeightTable& other) {
+    if (this != &other) {
+        TermWeightTable copy(other);
+        entries_ = std::move(copy.entries_);
+        term_count_ = copy.term_count_;
+        capacity_ = copy.capacity_;
+        version_ = copy.version_;
+    }
+    return *this;
+}
+
+/*! \fn TermWeightTable::Invalidate
+ *  \b   \b :   \n
+ *  \b   \b :     :   
+ *                         .   
+ *                            \n
+ *  \b  \b :     Get \n
+ *  \param[in] term_count    \n
+ *  \return  \n
+ */
+void TermWeightTable::Invalidate(size_t term_count) {
+    ++version_;
+    if (term_count > capacity_) {
+        capacity_ = std::max(term_count, 2 * capacity_);
+        entries_.reset(new Entry[capacity_]);
+    }
+    term_count_ = term_count;
+}
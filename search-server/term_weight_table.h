@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/*     : IDF      .
+       ,      
+        .        
+        .    :   ,
+       ,  */
+class TermWeightTable {
+public:
+    struct TermWeight {
+        double inverse_document_freq = 0.0;
+        double max_term_freq = 0.0; /*!<       */
+        double max_impact = 0.0;    /*!<         */
+    };
+
+    TermWeightTable() = default;
+    TermWeightTable(const TermWeightTable& other);
+    TermWeightTable& operator=(const TermWeightTable& other);
+
+    void Invalidate(size_t term_count);
+    template <typename ComputeWeight>
+    TermWeight Get(int term_id, ComputeWeight compute_weight) const;
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> version{ 0 }; /*!<   , 0 -    */
+        std::atomic<double> inverse_document_freq{ 0.0 };
+        std::atomic<double> max_term_freq{ 0.0 };
+        std::atomic<double> max_impact{ 0.0 };
+    };
+
+    std::unique_ptr<Entry[]> entries_;
+    size_t term_count_ = 0;
+    size_t capacity_ = 0;
+    uint64_t version_ = 1;
+};
+
+/*! \fn TermWeightTable::Get
+ *  \b   \b :   \n
+ *  \b   \b :   . ,    , 
+ *                       ,     \n
+ *  \b  \b :  ,     ,   \n
+ *  \param[in] term_id   \n
+ *  \param[in] compute_weight ,      \n
+ *  \return   \n
+ */
+template <typename ComputeWeight>
+TermWeightTable::TermWeight TermWeightTable::Get(int term_id, ComputeWeight compute_weight) const {
+    if (term_id < 0 || static_cast<size_t>(term_id) >= term_count_) {
+        return compute_weight(term_id);
+    }
+    Entry& entry = entries_[term_id];
+    if (entry.version.load(std::memory_order_acquire) == version_) {
+        return { entry.inverse_document_freq.load(std::memory_order_relaxed),
+            entry.max_term_freq.load(std::memory_order_relaxed),
+            entry.max_impact.load(std::memory_order_relaxed) };
+    }
+    const TermWeight weight = compute_weight(term_id);
+    entry.inverse_document_freq.store(weight.inverse_document_freq, std::memory_order_relaxed);
+    entry.max_term_freq.store(weight.max_term_freq, std::memory_order_relaxed);
+    entry.max_impact.store(weight.max_impact, std::memory_order_relaxed);
+    entry.version.store(version_, std::memory_order_release);
+    return weight;
+}
@@ -1 +1,1181 @@
-#include "test_example_functions.h"
\ No newline at end of file
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execution>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "chunked_map.h"
+#include "concurrent_map.h"
+#include "concurrent_search_server.h"
+#include "index_file.h"
+#include "mapped_file.h"
+#include "process_queries.h"
+#include "ranking.h"
+#include "remove_duplicates.h"
+#include "result_cache.h"
+#include "search_server.h"
+#include "stop_words.h"
+#include "test_example_functions.h"
+#include "text_arena.h"
+
+namespace {
+
+using namespace std::literals;
+
+void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func,
+                unsigned line, const std::string& hint)
+{
+    if (!value) {
+        std::cerr << file << "("s << line << "): "s << func << ": "s << "ASSERT("s << expr_str << ") failed."s;
+        if (!hint.empty()) {
+            std::cerr << " Hint: "s << hint;
+        }
+        std::cerr << std::endl;
+        std::abort();
+    }
+}
+
+#define ASSERT(expr) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, ""s)
+#define ASSERT_HINT(expr, hint) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+template <typename Function>
+void RunTestImpl(Function function, const std::string& function_name) {
+    function();
+    std::cerr << function_name << " OK"s << std::endl;
+}
+
+#define RUN_TEST(func) RunTestImpl((func), #func)
+
+/*  :      Exception */
+#define ASSERT_THROWS(expr, Exception)                                                     \
+    do {                                                                                   \
+        bool is_thrown = false;                                                            \
+        try {                                                                              \
+            (void)(expr);                                                                  \
+        }                                                                                  \
+        catch (const Exception&) {                                                         \
+            is_thrown = true;                                                              \
+        }                                                                                  \
+        AssertImpl(is_thrown, #expr " throws " #Exception, __FILE__, __FUNCTION__, __LINE__, ""s); \
+    } while (false)
+
+const double RELEVANCE_TOLERANCE = 1e-9;
+
+std::vector<std::string> SplitWords(const std::string& text) {
+    std::istringstream input(text);
+    std::vector<std::string> words;
+    for (std::string word; input >> word;) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+/*     :     .
+   TF -        -, IDF - log(N / df),
+    N  df        */
+class ReferenceServer {
+public:
+    explicit ReferenceServer(const std::string& stop_words) {
+        for (const std::string& word : SplitWords(stop_words)) {
+            stop_words_.insert(word);
+        }
+    }
+
+    void AddDocument(int document_id, const std::string& text, DocumentStatus status, const std::vector<int>& ratings) {
+        Entry& entry = documents_[document_id];
+        for (const std::string& word : SplitWords(text)) {
+            if (stop_words_.count(word) == 0) {
+                entry.words.push_back(word);
+            }
+        }
+        entry.status = status;
+        entry.rating = ratings.empty() ? 0 : std::accumulate(ratings.begin(), ratings.end(), 0) / static_cast<int>(ratings.size());
+    }
+
+    void RemoveDocument(int document_id) {
+        documents_.erase(document_id);
+    }
+
+    int GetDocumentCount() const {
+        return static_cast<int>(documents_.size());
+    }
+
+    /*       */
+    template <typename DocumentPredicate>
+    std::map<int, Document> FindAllDocuments(const std::string& raw_query, DocumentPredicate document_predicate) const {
+        const auto [plus_words, minus_words] = ParseQuery(raw_query);
+        std::map<std::string, double> inverse_document_freqs;
+        for (const std::string& word : plus_words) {
+            inverse_document_freqs[word] = ComputeInverseDocumentFreq(word);
+        }
+        std::map<int, Document> result;
+        for (const auto& [document_id, entry] : documents_) {
+            if (!document_predicate(document_id, entry.status, entry.rating) || HasAnyWord(entry, minus_words)) {
+                continue;
+            }
+            double relevance = 0.0;
+            bool has_plus_word = false;
+            for (const std::string& word : plus_words) {
+                const auto count = std::count(entry.words.begin(), entry.words.end(), word);
+                if (count > 0) {
+                    has_plus_word = true;
+                    relevance += count * 1.0 / entry.words.size() * inverse_document_freqs.at(word);
+                }
+            }
+            if (has_plus_word) {
+                result[document_id] = Document(document_id, relevance, entry.rating);
+            }
+        }
+        return result;
+    }
+
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const {
+        const Entry& entry = documents_.at(document_id);
+        const auto [plus_words, minus_words] = ParseQuery(raw_query);
+        std::vector<std::string> matched_words;
+        if (!HasAnyWord(entry, minus_words)) {
+            for (const std::string& word : plus_words) {
+                if (HasAnyWord(entry, { word })) {
+                    matched_words.push_back(word);
+                }
+            }
+        }
+        return { matched_words, entry.status };
+    }
+
+    std::map<std::string, double> GetWordFrequencies(int document_id) const {
+        std::map<std::string, double> result;
+        const auto iterator = documents_.find(document_id);
+        if (iterator != documents_.end()) {
+            for (const std::string& word : iterator->second.words) {
+                result[word] += 1.0 / iterator->second.words.size();
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::vector<std::string> words;
+        DocumentStatus status = DocumentStatus::ACTUAL;
+        int rating = 0;
+    };
+
+    std::set<std::string> stop_words_;
+    std::map<int, Entry> documents_;
+
+    std::pair<std::set<std::string>, std::set<std::string>> ParseQuery(const std::string& raw_query) const {
+        std::set<std::string> plus_words;
+        std::set<std::string> minus_words;
+        for (const std::string& word : SplitWords(raw_query)) {
+            const bool is_minus = word[0] == '-';
+            const std::string data = is_minus ? word.substr(1) : word;
+            if (stop_words_.count(data) == 0) {
+                (is_minus ? minus_words : plus_words).insert(data);
+            }
+        }
+        return { plus_words, minus_words };
+    }
+
+    static bool HasAnyWord(const Entry& entry, const std::set<std::string>& words) {
+        return std::any_of(entry.words.begin(), entry.words.end(),
+            [&words](const std::string& word) {return words.count(word) > 0;});
+    }
+
+    double ComputeInverseDocumentFreq(const std::string& word) const {
+        const auto document_freq = std::count_if(documents_.begin(), documents_.end(),
+            [&word](const auto& document) {return HasAnyWord(document.second, { word });});
+        return std::log(documents_.size() * 1.0 / document_freq);
+    }
+};
+
+/*        */
+struct RandomCorpus {
+    static constexpr int VOCABULARY_SIZE = 60;
+
+    std::mt19937 generator;
+
+    std::string GenerateText(int word_count) {
+        std::string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += (text.empty() ? "w"s : " w"s) +
+                std::to_string(std::uniform_int_distribution<int>(0, VOCABULARY_SIZE - 1)(generator));
+        }
+        return text;
+    }
+
+    std::string GenerateQuery() {
+        std::string query = GenerateText(std::uniform_int_distribution<int>(1, 4)(generator));
+        if (std::uniform_int_distribution<int>(0, 2)(generator) == 0) {
+            query += " -"s + GenerateText(1);
+        }
+        return query;
+    }
+
+    DocumentStatus GenerateStatus() {
+        static const DocumentStatus STATUSES[] = { DocumentStatus::ACTUAL, DocumentStatus::ACTUAL,
+            DocumentStatus::IRRELEVANT, DocumentStatus::BANNED, DocumentStatus::REMOVED };
+        return STATUSES[std::uniform_int_distribution<int>(0, 4)(generator)];
+    }
+
+    std::vector<int> GenerateRatings() {
+        std::vector<int> ratings(std::uniform_int_distribution<int>(0, 3)(generator));
+        for (int& rating : ratings) {
+            rating = std::uniform_int_distribution<int>(-10, 10)(generator);
+        }
+        return ratings;
+    }
+
+    /*            */
+    void AddDocuments(SearchServer& search_server, ReferenceServer& reference, int first_document_id, int count) {
+        for (int document_id = first_document_id; document_id < first_document_id + count; ++document_id) {
+            const std::string text = GenerateText(std::uniform_int_distribution<int>(1, 30)(generator));
+            const DocumentStatus status = GenerateStatus();
+            const std::vector<int> ratings = GenerateRatings();
+            search_server.AddDocument(document_id, text, status, ratings);
+            reference.AddDocument(document_id, text, status, ratings);
+        }
+    }
+};
+
+/*    :  ,       ,
+        .         */
+void AssertSameTopDocuments(const std::vector<Document>& actual, const std::map<int, Document>& expected_all,
+                            size_t max_result_count, const std::string& hint)
+{
+    std::vector<Document> expected;
+    for (const auto& [document_id, document] : expected_all) {
+        expected.push_back(document);
+    }
+    std::sort(expected.begin(), expected.end(), IsMoreRelevant);
+    expected.resize(std::min(expected.size(), max_result_count));
+
+    ASSERT_HINT(actual.size() == expected.size(), hint);
+    std::set<int> document_ids;
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_HINT(document_ids.insert(actual[i].id).second, hint);
+        const auto iterator = expected_all.find(actual[i].id);
+        ASSERT_HINT(iterator != expected_all.end(), hint);
+        ASSERT_HINT(std::abs(iterator->second.relevance - actual[i].relevance) < RELEVANCE_TOLERANCE, hint);
+        ASSERT_HINT(iterator->second.rating == actual[i].rating, hint);
+        ASSERT_HINT(std::abs(expected[i].relevance - actual[i].relevance) < RELEVANCE_EPS, hint);
+        ASSERT_HINT(expected[i].rating == actual[i].rating || std::abs(expected[i].relevance - actual[i].relevance) >= RELEVANCE_EPS, hint);
+    }
+}
+
+/* ,            */
+void AssertSameAsReference(const SearchServer& search_server, const ReferenceServer& reference,
+                           RandomCorpus& corpus, int max_document_id)
+{
+    ASSERT(search_server.GetDocumentCount() == reference.GetDocumentCount());
+    for (int i = 0; i < 50; ++i) {
+        const std::string query = corpus.GenerateQuery();
+        const auto actual = reference.FindAllDocuments(query,
+            [](int, DocumentStatus status, int) {return status == DocumentStatus::ACTUAL;});
+        AssertSameTopDocuments(search_server.FindTopDocuments(query), actual, MAX_RESULT_DOCUMENT_COUNT, query);
+        AssertSameTopDocuments(search_server.FindTopDocuments(std::execution::par, query), actual,
+            MAX_RESULT_DOCUMENT_COUNT, query);
+
+        AssertSameTopDocuments(search_server.FindTopDocuments(query, DocumentStatus::BANNED),
+            reference.FindAllDocuments(query, [](int, DocumentStatus status, int) {return status == DocumentStatus::BANNED;}),
+            MAX_RESULT_DOCUMENT_COUNT, query);
+        const auto even_positive = [](int document_id, DocumentStatus, int rating) {
+            return document_id % 2 == 0 && rating > 0;
+        };
+        AssertSameTopDocuments(search_server.FindTopDocuments(query, even_positive),
+            reference.FindAllDocuments(query, even_positive), MAX_RESULT_DOCUMENT_COUNT, query);
+
+        for (int j = 0; j < 5; ++j) {
+            const int document_id = std::uniform_int_distribution<int>(0, max_document_id)(corpus.generator);
+            if (reference.GetWordFrequencies(document_id).empty()) {
+                continue;
+            }
+            const auto [expected_words, expected_status] = reference.MatchDocument(query, document_id);
+            for (const auto& [words, status] : { search_server.MatchDocument(query, document_id),
+                    search_server.MatchDocument(std::execution::par, query, document_id) }) {
+                ASSERT_HINT(std::vector<std::string>(words.begin(), words.end()) == expected_words, query);
+                ASSERT_HINT(status == expected_status, query);
+            }
+        }
+    }
+
+    for (int document_id = 0; document_id <= max_document_id; ++document_id) {
+        const auto expected = reference.GetWordFrequencies(document_id);
+        const auto& actual = search_server.GetWordFrequencies(document_id);
+        ASSERT(actual.size() == expected.size());
+        for (const auto& [word, frequency] : actual) {
+            const auto iterator = expected.find(std::string(word));
+            ASSERT(iterator != expected.end() && std::abs(iterator->second - frequency) < RELEVANCE_TOLERANCE);
+        }
+    }
+}
+
+void TestExcludeStopWordsFromAddedDocumentContent() {
+    const int doc_id = 42;
+    const std::string content = "cat in the city"s;
+    const std::vector<int> ratings = { 1, 2, 3 };
+    {
+        SearchServer server(""s);
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        const auto found_docs = server.FindTopDocuments("in"s);
+        ASSERT(found_docs.size() == 1);
+        ASSERT(found_docs[0].id == doc_id);
+        ASSERT(found_docs[0].rating == 2);
+    }
+    {
+        SearchServer server("in the"s);
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        ASSERT(server.FindTopDocuments("in"s).empty());
+        ASSERT(server.GetWordFrequencies(doc_id).size() == 2);
+    }
+}
+
+void TestInvalidInput() {
+    SearchServer server("and"s);
+    server.AddDocument(1, "white cat"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_THROWS(server.AddDocument(1, "black dog"s, DocumentStatus::ACTUAL, { 1 }), std::invalid_argument);
+    ASSERT_THROWS(server.AddDocument(-1, "black dog"s, DocumentStatus::ACTUAL, { 1 }), std::invalid_argument);
+    ASSERT_THROWS(server.AddDocument(2, "black d\x12og"s, DocumentStatus::ACTUAL, { 1 }), std::invalid_argument);
+    ASSERT_THROWS(server.FindTopDocuments("--cat"s), std::invalid_argument);
+    ASSERT_THROWS(server.FindTopDocuments("cat -"s), std::invalid_argument);
+    ASSERT_THROWS(server.MatchDocument("cat"s, 2), std::out_of_range);
+    ASSERT(server.GetDocumentCount() == 1);
+}
+
+/*       ,    ,
+      ,    */
+void TestParallelErrorsAreRethrown() {
+    for (const bool has_thread_pool : { false, true }) {
+        SearchServer server("and"s);
+        if (has_thread_pool) {
+            server.SetThreadPool(std::make_shared<ThreadPool>(2));
+        }
+        std::vector<std::string> texts;
+        for (int i = 0; i < 100; ++i) {
+            texts.push_back(i == 57 ? "black d\x12og"s : "white cat "s + std::to_string(i));
+        }
+        std::vector<RawDocument> documents;
+        for (int i = 0; i < 100; ++i) {
+            documents.push_back({ i, texts[i], DocumentStatus::ACTUAL, { 1 } });
+        }
+        ASSERT_THROWS(server.AddDocuments(std::execution::par, documents), std::invalid_argument);
+        ASSERT(server.GetDocumentCount() == 0);
+
+        documents.erase(documents.begin() + 57);
+        server.AddDocuments(std::execution::par, documents);
+        ASSERT(server.GetDocumentCount() == 99);
+
+        std::vector<std::string> queries(50, "cat"s);
+        queries[31] = "cat --dog"s;
+        ASSERT_THROWS(server.FindTopDocumentsBatch(queries), std::invalid_argument);
+        queries[31] = "white"s;
+        ASSERT(server.FindTopDocumentsBatch(queries)[31].size() == MAX_RESULT_DOCUMENT_COUNT);
+    }
+}
+
+/*   ,  ParallelFor,     Submit,  
+   ParallelFor     */
+void TestThreadPoolWaitRunsOnlyOwnTasks() {
+    ThreadPool thread_pool(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = thread_pool.Submit([released]() {
+        released.wait();
+    });
+    std::future<std::thread::id> other = thread_pool.Submit([]() {
+        return std::this_thread::get_id();
+    });
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release.set_value();
+    });
+    std::atomic<size_t> sum{ 0 };
+    thread_pool.ParallelFor(100, [&sum](size_t i) {
+        sum += i;
+    });
+    releaser.join();
+    blocker.get();
+    ASSERT(sum == 4'950);
+    ASSERT(other.get() != std::this_thread::get_id());
+
+    ThreadPool nested_pool(2);
+    sum = 0;
+    nested_pool.ParallelFor(10, [&nested_pool, &sum](size_t i) {
+        nested_pool.ParallelFor(10, [&sum, i](size_t j) {
+            sum += i * 10 + j;
+        });
+    });
+    ASSERT(sum == 4'950);
+}
+
+/*       ,     
+    ,            */
+void TestJoinedStreamKeepsOrderAndWindow() {
+    static const size_t QUERY_COUNT = 20;
+    static const size_t WINDOW = 3;
+
+    SearchServer search_server("and"s);
+    for (int id = 0; id < 10; ++id) {
+        search_server.AddDocument(id, "cat "s + std::to_string(id) + " dog"s, DocumentStatus::ACTUAL, { id });
+    }
+    const auto thread_pool = std::make_shared<ThreadPool>(1);
+    search_server.SetThreadPool(thread_pool);
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < QUERY_COUNT; ++i) {
+        queries.push_back(std::to_string(i % 10) + (i % 2 == 0 ? " cat"s : ""s));
+    }
+    std::vector<Document> expected;
+    for (const std::vector<Document>& documents : ProcessQueries(search_server, queries)) {
+        expected.insert(expected.end(), documents.begin(), documents.end());
+    }
+
+    std::vector<Document> actual;
+    for (const Document& document : ProcessQueriesJoinedStream(search_server, std::vector<std::string>(queries))) {
+        actual.push_back(document);
+    }
+    ASSERT(actual.size() == expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_HINT(actual[i].id == expected[i].id && actual[i].relevance == expected[i].relevance, "document "s + std::to_string(i));
+    }
+
+    const auto count_executed_tasks = [&thread_pool]() {
+        return thread_pool->GetWorkerStats()[0].executed_tasks;
+    };
+    const uint64_t executed_before = count_executed_tasks();
+    {
+        JoinedDocumentStream stream = ProcessQueriesJoinedStream(search_server, queries, WINDOW);
+        auto iterator = stream.begin();
+        ASSERT(iterator != stream.end() && iterator->id == expected[0].id);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ASSERT(count_executed_tasks() - executed_before <= 1 + WINDOW);
+    }
+    ASSERT(count_executed_tasks() - executed_before <= 1 + WINDOW);
+    {
+        JoinedDocumentStream unread = ProcessQueriesJoinedStream(search_server, queries, WINDOW);
+    }
+    ASSERT(search_server.FindTopDocuments("cat"s).size() == MAX_RESULT_DOCUMENT_COUNT);
+}
+
+/*     ,         
+      .         */
+void TestSearchStopsOnDeadline() {
+    static const int DOCUMENT_COUNT = 5'000;
+    static const int CALLS_BEFORE_CANCEL = 10;
+
+    SearchServer search_server("and"s);
+    for (int id = 0; id < DOCUMENT_COUNT; ++id) {
+        search_server.AddDocument(id, "cat "s + std::to_string(id % 7), DocumentStatus::ACTUAL, { id });
+    }
+
+    for (const ScoringMode scoring_mode : { ScoringMode::EXHAUSTIVE, ScoringMode::WAND }) {
+        SearchOptions options;
+        options.scoring_mode = scoring_mode;
+        options.cancellation = CancellationToken::Create(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+        ASSERT(search_server.FindTopDocuments(std::execution::seq, "cat 3"s, DocumentStatus::ACTUAL, options).empty());
+    }
+
+    SearchOptions options;
+    options.cancellation = CancellationToken::Create();
+    int predicate_calls = 0;
+    const std::vector<Document> partial = search_server.FindTopDocuments(std::execution::seq, "cat"s,
+        [&options, &predicate_calls](int, DocumentStatus, int) {
+            if (++predicate_calls == CALLS_BEFORE_CANCEL) {
+                options.cancellation.Cancel();
+            }
+            return true;
+        }, options);
+    ASSERT(!partial.empty());
+    ASSERT_HINT(predicate_calls < DOCUMENT_COUNT / 2, std::to_string(predicate_calls));
+    for (const Document& document : partial) {
+        ASSERT(document.rating < DOCUMENT_COUNT / 2);
+    }
+
+    std::future<std::vector<Document>> expired;
+    std::future<std::vector<Document>> detached;
+    {
+        const ConcurrentSearchServer concurrent_search_server(search_server);
+        SearchOptions expired_options;
+        expired_options.cancellation = CancellationToken::Create(CancellationToken::Clock::now());
+        expired = concurrent_search_server.FindTopDocumentsAsync("cat"s, DocumentStatus::ACTUAL, expired_options);
+        detached = concurrent_search_server.FindTopDocumentsAsync("cat 3"s);
+    }
+    ASSERT(expired.get().empty());
+    ASSERT(detached.get().size() == MAX_RESULT_DOCUMENT_COUNT);
+}
+
+/*     ,      ,
+       */
+void TestQueryCacheFollowsChanges() {
+    SearchServer search_server("and"s);
+    search_server.AddDocument(1, "white cat"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT(search_server.FindTopDocuments("cat -dog"s).size() == 1);
+    ASSERT(search_server.FindTopDocuments("cat -dog"s).size() == 1);
+    ASSERT(search_server.PrepareQuery("-dog cat cat"s).GetText() == search_server.PrepareQuery("cat -dog"s).GetText());
+
+    search_server.AddDocument(2, "black dog"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(3, "black cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+    const std::vector<Document> documents = search_server.FindTopDocuments("cat -dog"s);
+    ASSERT(documents.size() == 1 && documents[0].id == 1);
+    ASSERT(search_server.FindTopDocuments("dog"s).size() == 2);
+
+    search_server.RemoveDocument(1);
+    ASSERT(search_server.FindTopDocuments("cat -dog"s).empty());
+    ASSERT_THROWS(search_server.FindTopDocuments("cat --dog"s), std::invalid_argument);
+    ASSERT_THROWS(search_server.FindTopDocuments("cat --dog"s), std::invalid_argument);
+}
+
+/*        ,    
+       ,    */
+void TestResultCacheFollowsChanges() {
+    SearchServer search_server("and"s);
+    search_server.AddDocument(1, "white cat"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(2, "black dog"s, DocumentStatus::ACTUAL, { 2 });
+    search_server.SetResultCacheCapacity(64);
+
+    ASSERT(search_server.FindTopDocuments("cat"s).size() == 1);
+    ASSERT(search_server.FindTopDocuments("cat"s).size() == 1);
+    ResultCache::Stats stats = search_server.GetResultCacheStats();
+    ASSERT(stats.hits == 1 && stats.misses == 1 && stats.size == 1 && stats.capacity == 64);
+
+    search_server.AddDocument(3, "black cat"s, DocumentStatus::ACTUAL, { 3 });
+    ASSERT(search_server.FindTopDocuments("cat"s).size() == 2);
+    search_server.RemoveDocument(1);
+    const std::vector<Document> documents = search_server.FindTopDocuments("cat"s);
+    ASSERT(documents.size() == 1 && documents[0].id == 3);
+    stats = search_server.GetResultCacheStats();
+    ASSERT(stats.hits == 1 && stats.misses == 3);
+
+    SearchOptions cancelled;
+    cancelled.cancellation = CancellationToken::Create();
+    cancelled.cancellation.Cancel();
+    ASSERT(search_server.FindTopDocuments(std::execution::seq, "dog"s, DocumentStatus::ACTUAL, cancelled).empty());
+    ASSERT(search_server.GetResultCacheStats().size == stats.size);
+    ASSERT(search_server.FindTopDocuments("dog"s).size() == 1);
+    stats = search_server.GetResultCacheStats();
+    ASSERT(stats.hits == 1 && stats.misses == 5);
+
+    static const int KEY_COUNT = 100;
+    static const size_t CAPACITY = 16;
+    ResultCache cache(CAPACITY);
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        cache.Put(std::to_string(i), { { i, 1.0, 0 } });
+    }
+    stats = cache.GetStats();
+    ASSERT(stats.size <= CAPACITY && stats.size > 0);
+    ASSERT(stats.evictions == KEY_COUNT - stats.size);
+    size_t found_count = 0;
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        if (const auto found = cache.Find(std::to_string(i))) {
+            ASSERT(found->size() == 1 && (*found)[0].id == i);
+            ++found_count;
+        }
+    }
+    stats = cache.GetStats();
+    ASSERT(found_count == stats.size);
+    ASSERT(stats.hits == found_count && stats.misses == KEY_COUNT - found_count);
+}
+
+/*  - -   -   ,    
+       ,  ,   ,      */
+void TestStopWordSetContainsOnlyStopWords() {
+    static constexpr std::string_view WORDS[] = { "a"sv, "and"sv, "in"sv, "the"sv, "with"sv, "of"sv, "to"sv };
+    static constexpr StaticStopWords<std::size(WORDS)> STATIC_STOP_WORDS(WORDS);
+    static_assert(STATIC_STOP_WORDS.Contains("and"sv) && !STATIC_STOP_WORDS.Contains("an"sv));
+
+    const StopWordSet static_set(STATIC_STOP_WORDS);
+    const StopWordSet runtime_set(std::set<std::string, std::less<>>(std::begin(WORDS), std::end(WORDS)));
+    for (const StopWordSet* stop_words : { &static_set, &runtime_set }) {
+        for (const std::string_view word : WORDS) {
+            ASSERT_HINT(stop_words->Contains(word), std::string(word));
+        }
+        for (const std::string_view word : { "an"sv, "andx"sv, "th"sv, "ant"sv, "b"sv, "withs"sv, ""sv }) {
+            ASSERT_HINT(!stop_words->Contains(word), std::string(word));
+        }
+    }
+    ASSERT(!StopWordSet().Contains("a"sv));
+    ASSERT(!StopWordSet().Contains(""sv));
+
+    static const int WORD_COUNT = 5'000;
+    std::set<std::string, std::less<>> words;
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        words.insert("s"s + std::to_string(i));
+    }
+    const StopWordSet large_set(words);
+    for (int i = 0; i < 2 * WORD_COUNT; ++i) {
+        ASSERT(large_set.Contains("s"s + std::to_string(i)) == (i < WORD_COUNT));
+        ASSERT(!large_set.Contains("t"s + std::to_string(i)));
+    }
+
+    static const std::string_view DUPLICATE_WORDS[] = { "a"sv, "b"sv, "a"sv };
+    static const std::string_view EMPTY_WORDS[] = { "a"sv, ""sv };
+    ASSERT_THROWS(StaticStopWords<3>(DUPLICATE_WORDS), std::invalid_argument);
+    ASSERT_THROWS(StaticStopWords<2>(EMPTY_WORDS), std::invalid_argument);
+
+    SearchServer search_server(STATIC_STOP_WORDS);
+    search_server.AddDocument(1, "the cat with a collar"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT(search_server.FindTopDocuments("the"s).empty());
+    ASSERT(search_server.GetWordFrequencies(1).size() == 2);
+}
+
+/*  :         , 
+     ,  ,   ,   .
+            */
+void TestTextArenaCompactsUnderChurn() {
+    static const int TEXT_COUNT = 3'000;
+
+    TextArena arena;
+    std::vector<std::string> expected;
+    std::vector<std::string_view> texts;
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        expected.push_back(std::string(200, static_cast<char>('a' + i % 26)) + std::to_string(i));
+        texts.push_back(arena.Add(expected.back()));
+    }
+    const std::string long_text(TextArena::CHUNK_SIZE, 'z');
+    const std::string_view long_view = arena.Add(long_text);
+    const size_t chunk_count = arena.GetMemoryStats().chunk_count;
+    ASSERT(arena.Release(long_view));
+    ASSERT(arena.GetMemoryStats().chunk_count == chunk_count - 1);
+
+    const TextArena copy = arena;
+    const std::vector<std::string_view> copied_texts = texts;
+    const std::string foreign = "foreign"s;
+    ASSERT(!arena.Release(foreign));
+    ASSERT(!arena.NeedsCompaction());
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        if (i % 4 != 0) {
+            ASSERT(arena.Release(texts[i]));
+            texts[i] = {};
+        }
+    }
+    ASSERT(arena.NeedsCompaction());
+
+    TextArena compacted;
+    for (std::string_view& text : texts) {
+        if (arena.Contains(text)) {
+            text = compacted.Add(text);
+        }
+    }
+    const TextArena::MemoryStats before = arena.GetMemoryStats();
+    const TextArena::MemoryStats after = compacted.GetMemoryStats();
+    arena = std::move(compacted);
+    ASSERT(after.text_count == before.text_count && after.live_bytes == before.live_bytes);
+    ASSERT(after.chunk_count * 2 < before.chunk_count);
+    ASSERT(!arena.NeedsCompaction());
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        ASSERT(copied_texts[i] == expected[i]);
+        ASSERT((i % 4 == 0) == (texts[i] == expected[i]));
+    }
+
+    static const int DOCUMENT_COUNT = 2'000;
+    static const int ROUND_COUNT = 5;
+    RandomCorpus corpus;
+    SearchServer search_server("and"s);
+    int next_document_id = 0;
+    for (; next_document_id < DOCUMENT_COUNT; ++next_document_id) {
+        search_server.AddDocument(next_document_id, corpus.GenerateText(70), DocumentStatus::ACTUAL, { 1 });
+    }
+    const SearchServer snapshot = search_server;
+    for (int round = 0; round < ROUND_COUNT; ++round) {
+        for (int i = 0; i < DOCUMENT_COUNT / 2; ++i) {
+            search_server.RemoveDocument(next_document_id - DOCUMENT_COUNT + i);
+        }
+        for (int i = 0; i < DOCUMENT_COUNT / 2; ++i, ++next_document_id) {
+            search_server.AddDocument(next_document_id, corpus.GenerateText(70), DocumentStatus::ACTUAL, { 1 });
+        }
+        const TextArena::MemoryStats stats = search_server.GetTextMemoryStats();
+        ASSERT(stats.text_count == DOCUMENT_COUNT);
+        ASSERT_HINT(stats.chunk_count * TextArena::CHUNK_SIZE <= 2 * stats.live_bytes + 2 * TextArena::CHUNK_SIZE,
+            std::to_string(stats.chunk_count) + " chunks for "s + std::to_string(stats.live_bytes) + " bytes"s);
+    }
+    ASSERT(snapshot.GetTextMemoryStats().text_count == DOCUMENT_COUNT);
+    ASSERT(!snapshot.GetWordFrequencies(0).empty());
+    ASSERT(search_server.GetWordFrequencies(0).empty());
+}
+
+/*         ,   -  
+    .     id,     .  
+    ,       */
+void TestRemoveDuplicatesKeepsLowerIds() {
+    SearchServer search_server("and"s);
+    search_server.AddDocument(10, "cat dog"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(1, "white cat and black dog"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(2, "dog black and white cat cat"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(3, "white cat black bird"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(4, "dog cat"s, DocumentStatus::BANNED, { 5 });
+    search_server.AddDocument(5, "white cat and black dog"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT(FindDuplicates(search_server, { 1.0, nullptr }) == std::vector<int>({ 2, 5, 10 }));
+
+    std::ostringstream log;
+    RemoveDuplicates(search_server, { 1.0, &log });
+    ASSERT(log.str() == "Found duplicate document id 2\nFound duplicate document id 5\nFound duplicate document id 10\n"s);
+    ASSERT(std::vector<int>(search_server.begin(), search_server.end()) == std::vector<int>({ 1, 3, 4 }));
+
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += " w"s + std::to_string(i);
+    }
+    search_server.AddDocument(20, text, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(21, text + " extra"s, DocumentStatus::ACTUAL, { 1 });
+    search_server.AddDocument(22, text + " x1 x2 x3 x4 x5"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT(FindDuplicates(search_server, { 0.9, nullptr }) == std::vector<int>({ 21 }));
+    ASSERT(FindDuplicates(search_server, { 0.75, nullptr }) == std::vector<int>({ 21, 22 }));
+    for (const double threshold : { 0.0, MIN_JACCARD_THRESHOLD / 2, 1.5 }) {
+        ASSERT_THROWS(FindDuplicates(search_server, { threshold, nullptr }), std::invalid_argument);
+    }
+
+    static const double THRESHOLD = 0.3;
+    SearchServer random_server(""s);
+    RandomCorpus corpus;
+    for (int document_id = 0; document_id < 500; ++document_id) {
+        random_server.AddDocument(document_id, corpus.GenerateText(std::uniform_int_distribution<int>(5, 15)(corpus.generator)),
+            DocumentStatus::ACTUAL, { 1 });
+    }
+    const auto jaccard = [&random_server](int lhs, int rhs) {
+        const auto& lhs_words = random_server.GetWordFrequencies(lhs);
+        const auto& rhs_words = random_server.GetWordFrequencies(rhs);
+        size_t common_count = 0;
+        for (const auto& [word, frequency] : lhs_words) {
+            common_count += rhs_words.count(word);
+        }
+        return static_cast<double>(common_count) / (lhs_words.size() + rhs_words.size() - common_count);
+    };
+    std::vector<int> expected;
+    std::vector<int> kept;
+    for (const int document_id : random_server) {
+        if (std::any_of(kept.begin(), kept.end(), [&](int kept_id) {return jaccard(kept_id, document_id) >= THRESHOLD;})) {
+            expected.push_back(document_id);
+        }
+        else {
+            kept.push_back(document_id);
+        }
+    }
+    const std::vector<int> actual = FindDuplicates(random_server, { THRESHOLD, nullptr });
+    for (const int document_id : actual) {
+        ASSERT_HINT(std::any_of(random_server.begin(), random_server.end(), [&](int other_id) {
+            return other_id < document_id && jaccard(other_id, document_id) >= THRESHOLD;
+        }), std::to_string(document_id));
+    }
+    ASSERT_HINT(expected.size() > 50 && actual.size() * 100 >= expected.size() * 95,
+        std::to_string(actual.size()) + " of "s + std::to_string(expected.size()));
+}
+
+/*  ,          */
+const int INITIAL_DOCUMENT_COUNT = 2'000;
+const int ADDED_DOCUMENT_COUNT = 1'000;
+
+void TestFindAndMatchAsReference() {
+    const std::string stop_words = "w1 w2"s;
+    SearchServer search_server(stop_words);
+    ReferenceServer reference(stop_words);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT);
+    AssertSameAsReference(search_server, reference, corpus, INITIAL_DOCUMENT_COUNT - 1);
+
+    std::vector<std::string> texts;
+    for (int i = 0; i < ADDED_DOCUMENT_COUNT; ++i) {
+        texts.push_back(corpus.GenerateText(std::uniform_int_distribution<int>(1, 30)(corpus.generator)));
+    }
+    std::vector<RawDocument> documents;
+    for (int i = 0; i < ADDED_DOCUMENT_COUNT; ++i) {
+        documents.push_back({ INITIAL_DOCUMENT_COUNT + i, texts[i], corpus.GenerateStatus(), corpus.GenerateRatings() });
+        reference.AddDocument(documents.back().id, texts[i], documents.back().status, documents.back().ratings);
+    }
+    search_server.AddDocuments(std::execution::par, documents);
+    AssertSameAsReference(search_server, reference, corpus, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT - 1);
+}
+
+/*          ,     */
+void TestBatchStrategiesAgree() {
+    static const int QUERY_COUNT = 300;
+
+    const std::string stop_words = "w1 w2"s;
+    SearchServer search_server(stop_words);
+    ReferenceServer reference(stop_words);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT);
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        queries.push_back(i % 10 == 9 ? queries[i / 2] : corpus.GenerateQuery());
+    }
+    const auto per_query = ProcessQueries(search_server, queries, QueryBatchStrategy::PER_QUERY);
+    const auto shared_postings = ProcessQueries(search_server, queries, QueryBatchStrategy::SHARED_POSTINGS);
+    ASSERT(shared_postings.size() == per_query.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_HINT(shared_postings[i].size() == per_query[i].size(), queries[i]);
+        for (size_t j = 0; j < per_query[i].size(); ++j) {
+            ASSERT_HINT(std::abs(shared_postings[i][j].relevance - per_query[i][j].relevance) < RELEVANCE_TOLERANCE, queries[i]);
+            ASSERT_HINT(shared_postings[i][j].rating == per_query[i][j].rating, queries[i]);
+        }
+        AssertSameTopDocuments(shared_postings[i], reference.FindAllDocuments(queries[i],
+            [](int, DocumentStatus status, int) {return status == DocumentStatus::ACTUAL;}),
+            MAX_RESULT_DOCUMENT_COUNT, queries[i]);
+    }
+}
+
+void TestRemoveDocumentsAsReference() {
+    const std::string stop_words = "w1 w2"s;
+    SearchServer search_server(stop_words);
+    /*     ,         */
+    ReferenceServer reference(stop_words);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT);
+
+    int end_document_id = INITIAL_DOCUMENT_COUNT;
+    for (int round = 0; round < 4; ++round) {
+        std::vector<int> removed_ids;
+        for (int i = 0; i < ADDED_DOCUMENT_COUNT / 2; ++i) {
+            removed_ids.push_back(std::uniform_int_distribution<int>(0, end_document_id - 1)(corpus.generator));
+        }
+        if (round % 2 == 0) {
+            search_server.RemoveDocuments(removed_ids);
+        }
+        else {
+            for (const int document_id : removed_ids) {
+                search_server.RemoveDocument(std::execution::par, document_id);
+            }
+        }
+        for (const int document_id : removed_ids) {
+            reference.RemoveDocument(document_id);
+        }
+        for (const int document_id : removed_ids) {
+            ASSERT(search_server.GetWordFrequencies(document_id).empty());
+            ASSERT_THROWS(search_server.MatchDocument("w3"s, document_id), std::out_of_range);
+        }
+        ASSERT(std::none_of(search_server.begin(), search_server.end(), [&removed_ids](int document_id) {
+            return std::count(removed_ids.begin(), removed_ids.end(), document_id) > 0;
+        }));
+        corpus.AddDocuments(search_server, reference, end_document_id, ADDED_DOCUMENT_COUNT / 4);
+        end_document_id += ADDED_DOCUMENT_COUNT / 4;
+        AssertSameAsReference(search_server, reference, corpus, end_document_id - 1);
+    }
+}
+
+/*       :     ,
+     - ,          */
+void TestServerCopiesAreIndependent() {
+    const std::string stop_words = "w1 w2"s;
+    SearchServer search_server(stop_words);
+    ReferenceServer reference(stop_words);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT);
+
+    SearchServer copy = search_server;
+    const ReferenceServer copy_reference = reference;
+    std::vector<int> removed_ids;
+    for (int document_id = 0; document_id < INITIAL_DOCUMENT_COUNT; document_id += 3) {
+        removed_ids.push_back(document_id);
+        reference.RemoveDocument(document_id);
+    }
+    search_server.RemoveDocuments(removed_ids);
+    corpus.AddDocuments(search_server, reference, INITIAL_DOCUMENT_COUNT, ADDED_DOCUMENT_COUNT);
+    AssertSameAsReference(copy, copy_reference, corpus, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT - 1);
+    AssertSameAsReference(search_server, reference, corpus, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT - 1);
+
+    std::map<int, int> expected;
+    ChunkedMap<int, int> values;
+    std::vector<std::pair<std::map<int, int>, ChunkedMap<int, int>>> copies;
+    for (int i = 0; i < 20'000; ++i) {
+        const int key = std::uniform_int_distribution<int>(0, 4'000)(corpus.generator);
+        if (i % 3 == 2) {
+            ASSERT(values.Erase(key) == (expected.erase(key) > 0));
+        }
+        else {
+            ASSERT(values.Insert(key, i) == expected.emplace(key, i).second);
+        }
+        if (i % 2'000 == 0) {
+            copies.emplace_back(expected, values);
+        }
+    }
+    copies.emplace_back(expected, values);
+    for (const auto& [expected_copy, values_copy] : copies) {
+        const std::vector<std::pair<int, int>> entries(values_copy.begin(), values_copy.end());
+        const std::vector<std::pair<int, int>> expected_entries(expected_copy.begin(), expected_copy.end());
+        ASSERT(values_copy.size() == expected_copy.size());
+        ASSERT(entries == expected_entries);
+        for (const auto& [key, value] : expected_copy) {
+            ASSERT(values_copy.Find(key) != nullptr && *values_copy.Find(key) == value);
+        }
+    }
+}
+
+std::string ReadFileBytes(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void WriteFileBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(bytes.data(), bytes.size());
+}
+
+const std::string TEST_INDEX_PATH = "test_search_index.bin"s;
+const std::string CORRUPTED_INDEX_PATH = "test_corrupted_index.bin"s;
+
+/*             BM25,  
+     .         ,
+   ,   ,       */
+void TestSavedIndexAsReference() {
+    const std::string stop_words = "w1 w2"s;
+    SearchServer search_server(stop_words);
+    ReferenceServer reference(stop_words);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT);
+    for (int document_id = 0; document_id < INITIAL_DOCUMENT_COUNT; document_id += 3) {
+        search_server.RemoveDocument(document_id);
+        reference.RemoveDocument(document_id);
+    }
+    search_server.Save(TEST_INDEX_PATH);
+
+    SearchServer loaded_server(MappedFile::Open(TEST_INDEX_PATH), true);
+    AssertSameAsReference(loaded_server, reference, corpus, INITIAL_DOCUMENT_COUNT - 1);
+    ASSERT(std::equal(loaded_server.begin(), loaded_server.end(), search_server.begin(), search_server.end()));
+    for (int i = 0; i < 50; ++i) {
+        const std::string query = corpus.GenerateQuery();
+        const auto expected = search_server.FindTopDocuments(std::execution::seq, query, DocumentStatus::ACTUAL,
+            SearchOptions{}, Bm25Ranking{});
+        const auto actual = loaded_server.FindTopDocuments(std::execution::seq, query, DocumentStatus::ACTUAL,
+            SearchOptions{}, Bm25Ranking{});
+        ASSERT_HINT(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end(),
+            [](const Document& lhs, const Document& rhs) {
+                return lhs.id == rhs.id && lhs.relevance == rhs.relevance && lhs.rating == rhs.rating;
+            }), query);
+    }
+
+    const SearchServer mapped_copy = loaded_server;
+    const ReferenceServer saved_reference = reference;
+    corpus.AddDocuments(loaded_server, reference, INITIAL_DOCUMENT_COUNT, ADDED_DOCUMENT_COUNT);
+    for (int document_id = 1; document_id < INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT; document_id += 5) {
+        loaded_server.RemoveDocument(document_id);
+        reference.RemoveDocument(document_id);
+    }
+    AssertSameAsReference(loaded_server, reference, corpus, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT - 1);
+    AssertSameAsReference(mapped_copy, saved_reference, corpus, INITIAL_DOCUMENT_COUNT - 1);
+
+    /*   :       - */
+    SearchServer empty_server(stop_words);
+    empty_server.AddDocument(1, "w1 w2"s, DocumentStatus::ACTUAL, { 1 });
+    empty_server.AddDocument(2, "w3"s, DocumentStatus::ACTUAL, { 1 });
+    empty_server.RemoveDocument(2);
+    empty_server.Save(TEST_INDEX_PATH);
+    SearchServer loaded_empty_server(MappedFile::Open(TEST_INDEX_PATH), true);
+    ASSERT(loaded_empty_server.GetDocumentCount() == 1);
+    ASSERT(loaded_empty_server.FindTopDocuments("w3"s).empty());
+    std::remove(TEST_INDEX_PATH.c_str());
+}
+
+/*       ,     
+      ,     */
+template <typename T, typename Modify>
+void AssertCorruptionRejected(IndexSection section, size_t index, Modify modify) {
+    std::string bytes = ReadFileBytes(TEST_INDEX_PATH);
+    {
+        const auto file = MappedFile::Open(TEST_INDEX_PATH);
+        const Span<T> values = IndexFileReader(file, false).GetSection<T>(section);
+        ASSERT(index < values.size());
+        T value = values[index];
+        modify(value);
+        std::memcpy(bytes.data() + (reinterpret_cast<const char*>(values.data() + index) - file->GetData()),
+            &value, sizeof(value));
+    }
+    WriteFileBytes(CORRUPTED_INDEX_PATH, bytes);
+    for (const bool verify_checksums : { false, true }) {
+        ASSERT_THROWS(SearchServer(MappedFile::Open(CORRUPTED_INDEX_PATH), verify_checksums), std::invalid_argument);
+    }
+}
+
+void TestCorruptedIndexFileIsRejected() {
+    SearchServer search_server("w1"s);
+    ReferenceServer reference("w1"s);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT / 4);
+    search_server.Save(TEST_INDEX_PATH);
+
+    const std::string bytes = ReadFileBytes(TEST_INDEX_PATH);
+    for (const std::string& damaged : { bytes.substr(0, 16), bytes.substr(0, bytes.size() / 2), bytes + "x"s }) {
+        WriteFileBytes(CORRUPTED_INDEX_PATH, damaged);
+        ASSERT_THROWS(SearchServer(MappedFile::Open(CORRUPTED_INDEX_PATH)), std::invalid_argument);
+    }
+
+    const uint64_t BAD_OFFSET = uint64_t(1) << 40;
+    AssertCorruptionRejected<uint64_t>(IndexSection::STOP_WORD_OFFSETS, 0, [](uint64_t& offset) {offset = 1;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::TERM_OFFSETS, 1, [&](uint64_t& offset) {offset = BAD_OFFSET;});
+    AssertCorruptionRejected<int>(IndexSection::SORTED_TERM_IDS, 0, [](int& term_id) {term_id = -1;});
+    AssertCorruptionRejected<int>(IndexSection::SEGMENT_TERM_IDS, 0,
+        [](int& term_id) {term_id = std::numeric_limits<int>::max();});
+    AssertCorruptionRejected<uint64_t>(IndexSection::SEGMENT_OFFSETS, 1, [&](uint64_t& offset) {offset = BAD_OFFSET;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::SEGMENT_OFFSETS, 1, [](uint64_t& offset) {offset += InvertedIndex::BLOCK_SIZE;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::SEGMENT_BLOCK_OFFSETS, 1, [](uint64_t& offset) {++offset;});
+    AssertCorruptionRejected<InvertedIndex::PostingBlock>(IndexSection::SEGMENT_BLOCKS, 0,
+        [&](InvertedIndex::PostingBlock& block) {block.data_offset = BAD_OFFSET;});
+    AssertCorruptionRejected<InvertedIndex::PostingBlock>(IndexSection::SEGMENT_BLOCKS, 1,
+        [](InvertedIndex::PostingBlock& block) {++block.data_offset;});
+    AssertCorruptionRejected<InvertedIndex::PostingBlock>(IndexSection::SEGMENT_BLOCKS, 0,
+        [](InvertedIndex::PostingBlock& block) {block.last_document_id = INITIAL_DOCUMENT_COUNT;});
+    AssertCorruptionRejected<uint8_t>(IndexSection::SEGMENT_DATA, 0, [](uint8_t& delta_width) {delta_width = 200;});
+    AssertCorruptionRejected<int>(IndexSection::SORTED_INTERNAL_IDS, 0, [](int& internal_id) {internal_id = -1;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::TEXT_OFFSETS, 1, [&](uint64_t& offset) {offset = BAD_OFFSET;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::FORWARD_OFFSETS, 1, [&](uint64_t& offset) {offset = BAD_OFFSET;});
+    AssertCorruptionRejected<uint64_t>(IndexSection::FORWARD_OFFSETS, 0, [](uint64_t& offset) {offset = 1;});
+    std::remove(TEST_INDEX_PATH.c_str());
+    std::remove(CORRUPTED_INDEX_PATH.c_str());
+}
+
+/*         ,   
+       */
+template <typename ExecutionPolicy, typename Filter, typename Ranking>
+void AssertWandAsExhaustive(const ExecutionPolicy& policy, const SearchServer& search_server, const std::string& query,
+                            Filter filter, size_t max_result_count, const Ranking& ranking)
+{
+    SearchOptions all_options;
+    all_options.max_result_count = static_cast<size_t>(search_server.GetDocumentCount());
+    std::map<int, Document> expected_all;
+    for (const Document& document : search_server.FindTopDocuments(std::execution::seq, query, filter, all_options, ranking)) {
+        expected_all[document.id] = document;
+    }
+    SearchOptions wand_options;
+    wand_options.max_result_count = max_result_count;
+    wand_options.scoring_mode = ScoringMode::WAND;
+    AssertSameTopDocuments(search_server.FindTopDocuments(policy, query, filter, wand_options, ranking),
+        expected_all, max_result_count, query);
+}
+
+void TestWandAsExhaustive() {
+    SearchServer search_server("w1 w2"s);
+    ReferenceServer reference("w1 w2"s);
+    RandomCorpus corpus;
+    corpus.AddDocuments(search_server, reference, 0, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT);
+    std::vector<int> removed_ids;
+    for (int i = 0; i < ADDED_DOCUMENT_COUNT; ++i) {
+        removed_ids.push_back(std::uniform_int_distribution<int>(0, INITIAL_DOCUMENT_COUNT + ADDED_DOCUMENT_COUNT - 1)(corpus.generator));
+    }
+    search_server.RemoveDocuments(removed_ids);
+
+    const auto even_positive = [](int document_id, DocumentStatus, int rating) {
+        return document_id % 2 == 0 && rating > 0;
+    };
+    const auto assert_wand_as_exhaustive = [&](const std::string& query, size_t max_result_count, const auto& ranking) {
+        AssertWandAsExhaustive(std::execution::seq, search_server, query, DocumentStatus::ACTUAL, max_result_count, ranking);
+        AssertWandAsExhaustive(std::execution::par, search_server, query, DocumentStatus::ACTUAL, max_result_count, ranking);
+        AssertWandAsExhaustive(std::execution::seq, search_server, query, DocumentStatus::BANNED, max_result_count, ranking);
+        AssertWandAsExhaustive(std::execution::seq, search_server, query, even_positive, max_result_count, ranking);
+        AssertWandAsExhaustive(std::execution::par, search_server, query, even_positive, max_result_count, ranking);
+    };
+    for (int i = 0; i < 100; ++i) {
+        const std::string query = corpus.GenerateQuery();
+        for (const size_t max_result_count : { size_t(1), size_t(MAX_RESULT_DOCUMENT_COUNT), size_t(50) }) {
+            assert_wand_as_exhaustive(query, max_result_count, TfIdfRanking{});
+            assert_wand_as_exhaustive(query, max_result_count, Bm25Ranking{});
+            assert_wand_as_exhaustive(query, max_result_count, Bm25Ranking(2.0, 0.0));
+        }
+    }
+}
+
+/*       ,     ,
+          */
+void TestConcurrentSearchServerPublishesChanges() {
+    ConcurrentSearchServer search_server(SearchServer("and"s));
+    search_server.AddDocument(1, "white cat"s, DocumentStatus::ACTUAL, { 1 });
+    const ConcurrentSearchServer::Snapshot snapshot = search_server.GetSnapshot();
+    search_server.AddDocument(2, "black cat"s, DocumentStatus::ACTUAL, { 2 });
+    search_server.RemoveDocument(1);
+    ASSERT(snapshot->GetDocumentCount() == 1);
+    ASSERT(search_server.GetDocumentCount() == 1);
+    ASSERT(search_server.FindTopDocuments("cat"s).size() == 1);
+    ASSERT(search_server.FindTopDocuments("cat"s)[0].id == 2);
+    ASSERT_THROWS(search_server.AddDocument(2, "dog"s, DocumentStatus::ACTUAL, { 1 }), std::invalid_argument);
+    ASSERT(search_server.GetDocumentCount() == 1);
+
+    static const int WRITER_COUNT = 4;
+    static const int DOCUMENT_COUNT = 200;
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < WRITER_COUNT; ++writer) {
+        threads.emplace_back([&search_server, writer] {
+            for (int document_id = 10 + writer; document_id < 10 + DOCUMENT_COUNT; document_id += WRITER_COUNT) {
+                search_server.AddDocument(document_id, "cat number "s + std::to_string(document_id), DocumentStatus::ACTUAL, { 1 });
+                ASSERT(std::get<0>(search_server.MatchDocument("cat"s, document_id)).size() == 1);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ASSERT(search_server.GetDocumentCount() == 1 + DOCUMENT_COUNT);
+}
+
+/*       ,      */
+void TestConcurrentMapAddsFromThreads() {
+    static const int THREAD_COUNT = 4;
+    static const int KEY_COUNT = 1'000;
+    static const int REPEAT_COUNT = 20;
+
+    ConcurrentMap<int, int> values(8);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < THREAD_COUNT; ++thread) {
+        threads.emplace_back([&values] {
+            for (int i = 0; i < REPEAT_COUNT; ++i) {
+                for (int key = 0; key < KEY_COUNT; ++key) {
+                    values.Add(key, 1);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT(values.Erase(0));
+    ASSERT(!values.Erase(0));
+    values.Update(1, [](int& value) {value = -1;});
+    const std::map<int, int> result = values.BuildOrdinaryMap();
+    ASSERT(result.size() == KEY_COUNT - 1);
+    ASSERT(result.at(1) == -1);
+    for (int key = 2; key < KEY_COUNT; ++key) {
+        ASSERT(result.at(key) == THREAD_COUNT * REPEAT_COUNT);
+    }
+    ASSERT(values.Extract().size() == KEY_COUNT - 1);
+    ASSERT(values.BuildOrdinaryMap().empty());
+}
+
+} // namespace
+
+void TestSearchServer() {
+    RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
+    RUN_TEST(TestInvalidInput);
+    RUN_TEST(TestParallelErrorsAreRethrown);
+    RUN_TEST(TestQueryCacheFollowsChanges);
+    RUN_TEST(TestResultCacheFollowsChanges);
+    RUN_TEST(TestStopWordSetContainsOnlyStopWords);
+    RUN_TEST(TestTextArenaCompactsUnderChurn);
+    RUN_TEST(TestRemoveDuplicatesKeepsLowerIds);
+    RUN_TEST(TestThreadPoolWaitRunsOnlyOwnTasks);
+    RUN_TEST(TestJoinedStreamKeepsOrderAndWindow);
+    RUN_TEST(TestSearchStopsOnDeadline);
+    RUN_TEST(TestFindAndMatchAsReference);
+    RUN_TEST(TestBatchStrategiesAgree);
+    RUN_TEST(TestRemoveDocumentsAsReference);
+    RUN_TEST(TestServerCopiesAreIndependent);
+    RUN_TEST(TestSavedIndexAsReference);
+    RUN_TEST(TestCorruptedIndexFileIsRejected);
+    RUN_TEST(TestWandAsExhaustive);
+    RUN_TEST(TestConcurrentSearchServerPublishesChanges);
+    RUN_TEST(TestConcurrentMapAddsFromThreads);
+}
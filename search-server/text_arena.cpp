@@ -0,0 +1,153 @@
+#include <string>
+
+#include "text_arena.h"
+
+TextArena::Chunk::Chunk(size_t size)
+    : data(new char[size])
+    , size(size)
+{
+}
+
+/*! \fn TextArena::Add
+ *  \b   \b :   \n
+ *  \b   \b :     \n
+ *  \b  \b :        ,
+ *                            \n
+ *  \param[in] text  \n
+ *  \return    \n
+ */
+std::string_view TextArena::Add(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    char* data = Allocate(text.size());
+    text.copy(data, text.size());
+    ++text_count_;
+    live_bytes_ += text.size();
+    return { data, text.size() };
+}
+
+/*! \fn TextArena::Release
+ *  \b   \b :   \n
+ *  \b   \b :   . ,     , ,
+ *                       ,     \n
+ *  \b  \b :        \n
+ *  \param[in] text ,   Add      \n
+ *  \return true,      \n
+ */
+bool TextArena::Release(std::string_view text) {
+    const auto iterator = chunks_.find(FindChunk(text));
+    if (iterator == chunks_.end()) {
+        return false;
+    }
+
+    ChunkUsage& usage = iterator->second;
+    usage.live_bytes -= text.size();
+    --text_count_;
+    live_bytes_ -= text.size();
+    if (usage.live_bytes == 0 && usage.chunk != current_chunk_) {
+        chunk_bytes_ -= usage.chunk->size;
+        chunks_.erase(iterator);
+    }
+    return true;
+}
+
+bool TextArena::Contains(std::string_view text) const {
+    return FindChunk(text) != nullptr;
+}
+
+/*! \fn TextArena::NeedsCompaction
+ *  \b   \b :   \n
+ *  \b   \b : ,       .
+ *                          ,     
+ *                      ,       \n
+ *  \b  \b :     \n
+ *  \return true,        \n
+ */
+bool TextArena::NeedsCompaction() const {
+    return chunk_bytes_ >= MIN_COMPACTION_BYTES && live_bytes_ * 2 < chunk_bytes_;
+}
+
+/*! \fn TextArena::GetMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :    \n
+ *  \b  \b : ,   ,     \n
+ *  \return   \n
+ */
+TextArena::MemoryStats TextArena::GetMemoryStats() const {
+    /*  std::map:  ,    - */
+    static const size_t MAP_NODE_SIZE = 4 * sizeof(void*) + sizeof(std::pair<const char* const, ChunkUsage>);
+
+    MemoryStats stats;
+    stats.text_count = text_count_;
+    stats.chunk_count = chunks_.size();
+    stats.live_bytes = live_bytes_;
+    stats.reserved_bytes = chunk_bytes_ + chunks_.size() * (MAP_NODE_SIZE + sizeof(Chunk));
+    return stats;
+}
+
+/*! \fn TextArena::EstimateStringMemoryStats
+ *  \b   \b :   \n
+ *  \b   \b :      ,    
+ *                      std::shared_ptr<const std::string>,     \n
+ *  \b  \b : ,      std::string,  
+ *                                16  \n
+ *  \param[in] text_count   \n
+ *  \param[in] text_bytes    \n
+ *  \return   \n
+ */
+TextArena::MemoryStats TextArena::EstimateStringMemoryStats(size_t text_count, size_t text_bytes) {
+    static const size_t ALLOCATION_OVERHEAD = 16;
+    /* ,  make_shared    ,    */
+    static const size_t STRING_SIZE = sizeof(std::shared_ptr<const std::string>) +
+        2 * sizeof(long) + sizeof(std::string) + ALLOCATION_OVERHEAD + 1 + ALLOCATION_OVERHEAD;
+
+    MemoryStats stats;
+    stats.text_count = text_count;
+    stats.live_bytes = text_bytes;
+    stats.reserved_bytes = text_bytes + text_count * STRING_SIZE;
+    return stats;
+}
+
+/*      ,    , 
+        */
+char* TextArena::Allocate(size_t size) {
+    if (size <= CHUNK_SIZE / 4 && current_chunk_) {
+        const size_t offset = current_chunk_->used.fetch_add(size);
+        if (offset + size <= current_chunk_->size) {
+            chunks_.at(current_chunk_->data.get()).live_bytes += size;
+            return current_chunk_->data.get() + offset;
+        }
+    }
+
+    auto chunk = std::make_shared<Chunk>(size <= CHUNK_SIZE / 4 ? CHUNK_SIZE : size);
+    chunk->used = size;
+    chunk_bytes_ += chunk->size;
+    char* data = chunk->data.get();
+    if (size <= CHUNK_SIZE / 4) {
+        if (current_chunk_) {
+            const auto iterator = chunks_.find(current_chunk_->data.get());
+            if (iterator->second.live_bytes == 0) {
+                chunk_bytes_ -= current_chunk_->size;
+                chunks_.erase(iterator);
+            }
+        }
+        current_chunk_ = chunk;
+    }
+    chunks_.emplace(data, ChunkUsage{ std::move(chunk), size });
+    return data;
+}
+
+/*  ,    ,  nullptr,      */
+const char* TextArena::FindChunk(std::string_view text) const {
+    if (text.empty()) {
+        return nullptr;
+    }
+    auto iterator = chunks_.upper_bound(text.data());
+    if (iterator == chunks_.begin()) {
+        return nullptr;
+    }
+    --iterator;
+    const Chunk& chunk = *iterator->second.chunk;
+    return text.data() + text.size() <= chunk.data.get() + chunk.size ? iterator->first : nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string_view>
+
+/*            .
+     .     :   
+       ,    ,  string_view,
+     ,    .   
+    ,     ,     :
+         , . NeedsCompaction */
+class TextArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+    static constexpr size_t MIN_COMPACTION_BYTES = 4 * CHUNK_SIZE;
+
+    struct MemoryStats {
+        size_t text_count = 0;
+        size_t chunk_count = 0;
+        size_t live_bytes = 0;     /*!<    */
+        size_t reserved_bytes = 0; /*!<      */
+    };
+
+    std::string_view Add(std::string_view text);
+    bool Release(std::string_view text);
+    bool Contains(std::string_view text) const;
+    bool NeedsCompaction() const;
+
+    MemoryStats GetMemoryStats() const;
+    static MemoryStats EstimateStringMemoryStats(size_t text_count, size_t text_bytes);
+
+private:
+    struct Chunk {
+        explicit Chunk(size_t size);
+
+        std::unique_ptr<char[]> data;
+        size_t size;
+        std::atomic<size_t> used{ 0 }; /*!<   ,      */
+    };
+
+    struct ChunkUsage {
+        std::shared_ptr<Chunk> chunk;
+        size_t live_bytes = 0;
+    };
+
+    std::map<const char*, ChunkUsage> chunks_; /*!<     */
+    std::shared_ptr<Chunk> current_chunk_;     /*!< ,      */
+    size_t text_count_ = 0;
+    size_t live_bytes_ = 0;
+    size_t chunk_bytes_ = 0;
+
+    char* Allocate(size_t size);
+    const char* FindChunk(std::string_view text) const;
+};
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <iterator>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "thread_pool.h"
+
+namespace {
+
+const size_t NO_WORKER = static_cast<size_t>(-1);
+
+/*    ,  .       */
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = NO_WORKER;
+
+} // namespace
+
+/*! \fn ThreadPool::ThreadPool
+ *  \b   \b :   \n
+ *  \b   \b :    \n
+ *  \b  \b :       Linux,  
+ *                        pinning  .    
+ *                        \n
+ *  \param[in] worker_count   \n
+ *  \param[in] pinning     \n
+ */
+ThreadPool::ThreadPool(size_t worker_count, CpuPinning pinning) {
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    threads_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        threads_.emplace_back([this, i]() {WorkerLoop(i);});
+        if (pinning == CpuPinning::CORE) {
+            PinThread(threads_.back(), i % std::max(1u, std::thread::hardware_concurrency()));
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(sleep_mutex_);
+        is_stopped_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+/*         ,     */
+std::shared_ptr<ThreadPool> ThreadPool::GetDefault() {
+    static const std::shared_ptr<ThreadPool> default_pool = std::make_shared<ThreadPool>();
+    return default_pool;
+}
+
+size_t ThreadPool::GetWorkerCount() const {
+    return workers_.size();
+}
+
+/*! \fn ThreadPool::GetWorkerStats
+ *  \b   \b :   \n
+ *  \b   \b :        \n
+ *  \b  \b :  \n
+ *  \return   \n
+ */
+std::vector<ThreadPool::WorkerStats> ThreadPool::GetWorkerStats() const {
+    std::vector<WorkerStats> result;
+    result.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        result.push_back({ worker->executed_tasks.load(std::memory_order_relaxed),
+            worker->stolen_tasks.load(std::memory_order_relaxed) });
+    }
+    return result;
+}
+
+/*       ,       ,
+      .        */
+void ThreadPool::Push(Task task) {
+    size_t worker = GetCurrentWorker();
+    if (worker == NO_WORKER) {
+        worker = next_queue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    }
+    {
+        std::lock_guard guard(workers_[worker]->mutex);
+        workers_[worker]->tasks.push_back(std::move(task));
+    }
+    queued_task_count_.fetch_add(1);
+    {
+        std::lock_guard guard(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+/*! \fn ThreadPool::TryRunTask
+ *  \b   \b :   \n
+ *  \b   \b :   :      
+ *                       ,     \n
+ *  \b  \b :   ,     \n
+ *  \param[in] worker    \n
+ *  \param[in] group    nullptr    \n
+ *  \return true,    \n
+ */
+bool ThreadPool::TryRunTask(size_t worker, const TaskGroup* group) {
+    auto is_suitable = [group](const Task& task) {
+        return group == nullptr || task.group == group;
+    };
+
+    Task task;
+    bool is_found = false;
+    bool is_stolen = false;
+    {
+        std::lock_guard guard(workers_[worker]->mutex);
+        std::deque<Task>& tasks = workers_[worker]->tasks;
+        const auto iterator = std::find_if(tasks.rbegin(), tasks.rend(), is_suitable);
+        if (iterator != tasks.rend()) {
+            task = std::move(*iterator);
+            tasks.erase(std::next(iterator).base());
+            is_found = true;
+        }
+    }
+    for (size_t i = 1; !is_found && i < workers_.size(); ++i) {
+        const size_t victim = (worker + i) % workers_.size();
+        std::lock_guard guard(workers_[victim]->mutex);
+        std::deque<Task>& tasks = workers_[victim]->tasks;
+        const auto iterator = std::find_if(tasks.begin(), tasks.end(), is_suitable);
+        if (iterator != tasks.end()) {
+            task = std::move(*iterator);
+            tasks.erase(iterator);
+            is_found = true;
+            is_stolen = true;
+        }
+    }
+    if (!is_found) {
+        return false;
+    }
+
+    queued_task_count_.fetch_sub(1);
+    workers_[worker]->executed_tasks.fetch_add(1, std::memory_order_relaxed);
+    if (is_stolen) {
+        workers_[worker]->stolen_tasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    RunTask(task);
+    return true;
+}
+
+/*      :     
+    ,      ,      */
+void ThreadPool::RunTask(Task& task) {
+    std::exception_ptr error;
+    try {
+        task.function();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    if (task.group == nullptr) {
+        return;
+    }
+    TaskGroup& group = *task.group;
+    std::lock_guard guard(group.mutex);
+    if (error && !group.error) {
+        group.error = error;
+    }
+    if (group.pending.fetch_sub(1) == 1) {
+        group.done.notify_all();
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t worker) {
+    current_pool = this;
+    current_worker = worker;
+
+    while (true) {
+        if (TryRunTask(worker)) {
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this]() {
+            return is_stopped_ || queued_task_count_.load() > 0;
+        });
+        if (is_stopped_ && queued_task_count_.load() == 0) {
+            return;
+        }
+    }
+}
+
+/*! \fn ThreadPool::Wait
+ *  \b   \b :   \n
+ *  \b   \b :    .     ,
+ *                          ,   ,    \n
+ *  \b  \b :     Submit  ,   
+ *                                \n
+ *  \param[in] group   \n
+ *  \return  \n
+ */
+void ThreadPool::Wait(TaskGroup& group) {
+    const size_t worker = GetCurrentWorker();
+    if (worker != NO_WORKER) {
+        while (group.pending.load() > 0 && TryRunTask(worker, &group)) {
+        }
+    }
+    std::unique_lock lock(group.mutex);
+    group.done.wait(lock, [&group]() {
+        return group.pending.load() == 0;
+    });
+}
+
+size_t ThreadPool::GetCurrentWorker() const {
+    return current_pool == this ? current_worker : NO_WORKER;
+}
+
+void ThreadPool::PinThread(std::thread& thread, size_t cpu) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
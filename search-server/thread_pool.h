@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class CpuPinning {
+    NONE, /*!<     */
+    CORE, /*!<  i    i     */
+};
+
+/*     .     :     
+    ,        .  , 
+     ,     ,   
+     .      :     
+    ,   .      */
+class ThreadPool {
+public:
+    struct WorkerStats {
+        uint64_t executed_tasks = 0; /*!<  ,   */
+        uint64_t stolen_tasks = 0;   /*!<      */
+    };
+
+    explicit ThreadPool(size_t worker_count = std::thread::hardware_concurrency(),
+                        CpuPinning pinning = CpuPinning::NONE);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    template <typename Function>
+    void ParallelFor(size_t count, Function function);
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> Submit(Function function);
+
+    static std::shared_ptr<ThreadPool> GetDefault();
+
+    size_t GetWorkerCount() const;
+    std::vector<WorkerStats> GetWorkerStats() const;
+
+private:
+    /*    ParallelFor */
+    struct TaskGroup {
+        std::atomic<size_t> pending{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error; /*!<     */
+    };
+
+    struct Task {
+        std::function<void()> function;
+        TaskGroup* group = nullptr; /*!<    Submit,     */
+    };
+
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::atomic<uint64_t> executed_tasks{ 0 };
+        std::atomic<uint64_t> stolen_tasks{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_task_count_{ 0 };
+    std::atomic<size_t> next_queue_{ 0 };
+    bool is_stopped_ = false;
+
+    void Push(Task task);
+    bool TryRunTask(size_t worker, const TaskGroup* group = nullptr);
+    void RunTask(Task& task);
+    void WorkerLoop(size_t worker);
+    void Wait(TaskGroup& group);
+    size_t GetCurrentWorker() const;
+    static void PinThread(std::thread& thread, size_t cpu);
+};
+
+/*! \fn ThreadPool::ParallelFor
+ *  \b   \b :   \n
+ *  \b   \b :  function(i)   i  [0, count)   . 
+ *                        ,      ,  
+ *                          .  
+ *                         ,     \n
+ *  \b  \b :     .    ,
+ *                              \n
+ *  \param[in] count   \n
+ *  \param[in] function ,   \n
+ *  \return  \n
+ */
+template <typename Function>
+void ThreadPool::ParallelFor(size_t count, Function function) {
+    static const size_t CHUNKS_PER_WORKER = 4;
+
+    if (count == 0) {
+        return;
+    }
+    const size_t chunk_count = std::min(count, std::max<size_t>(1, workers_.size() * CHUNKS_PER_WORKER));
+    if (chunk_count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    TaskGroup group;
+    group.pending = chunk_count;
+    const size_t chunk_size = count / chunk_count;
+    const size_t remainder = count % chunk_count;
+    size_t first = 0;
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const size_t last = first + chunk_size + (chunk < remainder ? 1 : 0);
+        Push({ [&function, first, last]() {
+                   for (size_t i = first; i < last; ++i) {
+                       function(i);
+                   }
+               }, &group });
+        first = last;
+    }
+    Wait(group);
+    if (group.error) {
+        std::rethrow_exception(group.error);
+    }
+}
+
+/*! \fn ThreadPool::Submit
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :        .
+ *                          future \n
+ *  \param[in] function    \n
+ *  \return    \n
+ */
+template <typename Function>
+std::future<std::invoke_result_t<Function>> ThreadPool::Submit(Function function) {
+    using Result = std::invoke_result_t<Function>;
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+    std::future<Result> result = task->get_future();
+    if (workers_.empty()) {
+        (*task)();
+        return result;
+    }
+    Push({ [task]() {(*task)();}, nullptr });
+    return result;
+}
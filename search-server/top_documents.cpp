@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+
+#include "top_documents.h"
+
+/*! \fn IsMoreRelevant
+ *  \b   \b :   \n
+ *  \b   \b :    :   ,
+ *                           RELEVANCE_EPS -    \n
+ *  \b  \b :  \n
+ *  \param[in] lhs  \n
+ *  \param[in] rhs  \n
+ *  \return true,  lhs      rhs \n
+ */
+bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < RELEVANCE_EPS) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+TopDocuments::TopDocuments(size_t capacity)
+    : capacity_(capacity)
+{
+    heap_.reserve(capacity);
+}
+
+/*! \fn TopDocuments::Add
+ *  \b   \b :   \n
+ *  \b   \b :        O(log K) \n
+ *  \b  \b :  \n
+ *  \param[in] document  \n
+ *  \return  \n
+ */
+void TopDocuments::Add(const Document& document) {
+    if (heap_.size() < capacity_) {
+        heap_.push_back(document);
+        std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    }
+    else if (capacity_ > 0 && IsMoreRelevant(document, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        heap_.back() = document;
+        std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    }
+}
+
+/*! \fn TopDocuments::Merge
+ *  \b   \b :   \n
+ *  \b   \b :   ,      \n
+ *  \b  \b :  \n
+ *  \param[in] other    \n
+ *  \return  \n
+ */
+void TopDocuments::Merge(const TopDocuments& other) {
+    for (const Document& document : other.heap_) {
+        Add(document);
+    }
+}
+
+bool TopDocuments::IsFull() const {
+    return heap_.size() >= capacity_;
+}
+
+/*! \fn TopDocuments::GetWorst
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :      \n
+ *  \return  \n
+ */
+const Document& TopDocuments::GetWorst() const {
+    return heap_.front();
+}
+
+size_t TopDocuments::GetSize() const {
+    return heap_.size();
+}
+
+size_t TopDocuments::GetCapacity() const {
+    return capacity_;
+}
+
+/*! \fn TopDocuments::Extract
+ *  \b   \b :   \n
+ *  \b   \b :       \n
+ *  \b  \b :     \n
+ *  \return     \n
+ */
+std::vector<Document> TopDocuments::Extract() {
+    std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    std::vector<Document> result = std::move(heap_);
+    heap_.clear();
+    return result;
+}
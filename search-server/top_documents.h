@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "document.h"
+
+const double RELEVANCE_EPS = 1e-6;
+
+bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t capacity);
+
+    void Add(const Document& document);
+    void Merge(const TopDocuments& other);
+    bool IsFull() const;
+    const Document& GetWorst() const;
+    size_t GetSize() const;
+    size_t GetCapacity() const;
+    std::vector<Document> Extract();
+
+private:
+    size_t capacity_;
+    std::vector<Document> heap_; /*!< ,       */
+};